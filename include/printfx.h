@@ -45,7 +45,7 @@ extern "C" {
 
 /* ############################### CHOOSING AN OUTPUT ROUTE #######################################
  *
- * FOUR routes, and they are NOT interchangeable. Picking by habit is how debug relics end up on
+ * FIVE routes, and they are NOT interchangeable. Picking by habit is how debug relics end up on
  * paths that cannot tolerate them. Measured properties, see analysis/uart-console-io-flow.md S81:
  *
  *  route            mechanism                    blocks?              on pressure / notes
@@ -56,6 +56,8 @@ extern "C" {
  *  PX*  printfx     staged -> RTC ubuf or UART   up to ~2 s           evicts old buffer content.
  *                                                (stage + uart locks,  telnet-visible. THE DEFAULT.
  *                                                 both WPFX_TIMEOUT)
+ *  PXD  tprintfx    as PX*, bounded waits        until the DEADLINE   DROPS the whole message and
+ *                                                (absolute, uSec)      counts it against the site.
  *  RP* / IRP*       esp_rom_printf               ROM, direct          IRP* only in ISR context.
  *  SL_* vSyslog     console AND/OR host          UNBOUNDED            shSLvars is portMAX_DELAY,
  *                                                                     then a TCP send, then an LFS
@@ -77,6 +79,11 @@ extern "C" {
  *     works. Existing users: vReportDebug (report.c), xpDebugMem / xpDebugFlags / xpDebugSpin
  *     (printfx_v0.c). Development helpers with no permanent call sites - that is normal for this
  *     category, do NOT read "unused" as "delete".
+ *  6. Use PXD where a late message is worse than a lost one - control loops, sampling tasks. The
+ *     deadline is ABSOLUTE (halTIMER_ReadRunTime() uSec, see xpfDEADLINE) and covers the stage and
+ *     uart lock waits. A dropped message returns xpfDROPPED and bumps the drop counter of the calling
+ *     site, vPrintfxDropReport() lists them. Messages larger than a stage block are truncated, never
+ *     rendered the slow way.
  *
  * Three axes decide a site: CONTEXT (can it run cache-disabled?), GATING (compile-time dead, guard
  * dead, or reachable?) and LATENCY (would a multi-second stall break something?).
@@ -109,6 +116,12 @@ unsigned long long halTIMER_ReadRunTime(void);
 #define	IF_PXT(T, f, ...)			if (T) PXT(f, ##__VA_ARGS__)
 #define	IF_PXTL(T, f, ...)			if (T) PXTL(f, ##__VA_ARGS__)
 
+/* One pxd_site_t per call site, created by the macro, linked into the drop list on its first drop */
+#define	PXD(D, f, ...)				({ static pxd_site_t sPXD = { .pcFunc = __FUNCTION__, .Line = __LINE__ };	\
+									tprintfx(&sPXD, D, f, ##__VA_ARGS__); })
+#define	PXDT(D, f, ...)				PXD(D, _T_(f), ##__VA_ARGS__)
+#define	IF_PXD(T, D, f, ...)		if (T) PXD(D, f, ##__VA_ARGS__)
+
 // Using ROM based esp_rom_printf (no 64bit support so 32bit timestamps)
 #define	_RL_(f)						"[%s:%d] " f, __FUNCTION__, __LINE__
 #define	_RT_(f)						"%u.%03u " f, halTIMER_ReadRunSeconds(), halTIMER_ReadRunMillis()
@@ -156,6 +169,10 @@ unsigned long long halTIMER_ReadRunTime(void);
  * has ever shipped, so the suite was permanently in the field image for no benefit. */
 #define	printfxTESTS				0
 
+/* 1 = trust %s/%U/%M/%Y/%D/%T/%Z pointers, only NULL is caught. 0 = range check every one against
+ * the region map, so a corrupt pointer prints "pOOR" instead of faulting. */
+#define	xpfTRUST_POINTERS			0
+
 #define	xpfMAXIMUM_DECIMALS			15
 #define	xpfDEFAULT_DECIMALS			6
 
@@ -164,6 +181,18 @@ unsigned long long halTIMER_ReadRunTime(void);
 
 #define xpfMAXWIDTH_HEXDUMP			32
 
+#define	xpfSPILL_BLOCKS				4					// printfx overflow blocks, shared by both cores
+#define	xpfSPILL_SIZE				256					// bytes per overflow block
+
+#define	xpfNEST_DEPTH				3					// nested printfx levels kept on the fast path
+#define	xpfNEST_SIZE				128					// bytes per nest buffer, spills as above
+
+#define	xpfDUMP_BLOCK				256					// streaming hexdump prefetch buffer size
+
+#define	xpfTZ_YEARS					3					// years of DST transitions, centred on xPrintfxZoneSet() Year
+
+#define	xpfSGR_CACHE				8					// attribute escapes cached, power of 2
+
 // ################################## C11 Pointer size determination ###############################
 
 static_assert(sizeof (void*) == sizeof (uintptr_t), "TBD code needed to determine pointer size");
@@ -201,7 +230,9 @@ static_assert(sizeof (void*) == sizeof (uintptr_t), "TBD code needed to determin
 #define	xpfMAX_LEN_B64				(xpfMAX_LEN_B32 * 2)
 
 #define	xpfMAX_LEN_IP				sizeof("123.456.789.012")
+#define	xpfMAX_LEN_IPV6				sizeof("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255")
 #define	xpfMAX_LEN_MAC				sizeof("01:23:45:67:89:ab")
+#define	xpfMAX_LEN_UUID				sizeof("01234567-89ab-cdef-0123-456789abcdef")
 
 #define	xpfLEN_SGR_ANSI				"\e[xxx;xxx?\000"
 #define	xpfLEN_SGR_LVGL_COL			"#?????? "
@@ -248,10 +279,36 @@ static_assert(sizeof (void*) == sizeof (uintptr_t), "TBD code needed to determin
 
 #define WPFX_TIMEOUT				pdMS_TO_TICKS(1000)
 
+#define	xpfDEADLINE(uS)				(halTIMER_ReadRunTime() + (uS))	// absolute deadline, uS from now
+#define	xpfDROPPED					(-2)				// tprintfx() status, message dropped on deadline
+
 // ####################################### enumerations ############################################
 
 enum { sgrNONE, sgrANSI, sgrAGFX, sgrLVGL };
 
+// Streaming hexdump options, same meaning as the %Y modifier shown
+enum {
+	xpdREL		= (1 << 0),								// '!' relative address
+	xpdNOADDR	= (1 << 1),								// '-' no address
+	xpdASCII	= (1 << 2),								// '+' ASCII column
+	xpdGROUP	= (1 << 3),								// ''' grouping separators
+	xpdREVERSE	= (1 << 4),								// '#' reverse order
+	xpdS8		= (0 << 5),								// 'hh' byte values
+	xpdS16		= (1 << 5),								// 'h' half word values
+	xpdS32		= (2 << 5),								// 'l' word values
+	xpdS64		= (3 << 5),								// 'll' double word values
+	xpdSIZE		= (3 << 5),
+	xpdSQUEEZE	= (1 << 7),								// '0' collapse duplicate lines
+};
+
+// Batch timestamp options, same meaning as the %R/%Z modifier shown
+enum {
+	xptFRAC		= (7 << 0),								// '.N' fraction digits, 0 to 6
+	xptGROUP	= (1 << 3),								// ''' "2017/09/10 12h34m56s" separators
+	xptZULU		= (1 << 4),								// 'Z' suffix, as %Z without TZ info
+	xptLOCAL	= (1 << 5),								// '+' local time & zone, as %+Z, see xPrintfxZoneSet()
+};
+
 // #################################### Public structures ##########################################
 
 //typedef union sgr_info_t {
@@ -288,7 +345,8 @@ typedef struct __attribute__((packed)) xpc_flg_t {
 	unsigned char bFloat : 1;					// array printing FLOAT values
 	unsigned char bGT:1;						// convert to LC
 	unsigned char bLT:1;						// convert to UC 
-	unsigned char uSpare : 2;
+	unsigned char bMatrix : 1;					// "&&" matrix layout as parameter
+	unsigned char bIEC : 1;						// "##" IEC scaling, steps of 1024
 	// start flg2, sum of bit widths below = XPC_BITS_XFER
 	unsigned char bDebug : 1;					// debug flag from xvReport
 	unsigned char uSGR : 2;						// check to align with report_t size struct
@@ -300,12 +358,53 @@ typedef struct __attribute__((packed)) xpc_val_t {
 	unsigned long flg2 : XPC_BITS_XFER;			// flags to be retained
 } xpc_val_t;
 
+/* Deadline (PXD) call site drop accounting, statically allocated by the PXD macro */
+typedef struct pxd_site_t {
+	const char * pcFunc;								// __FUNCTION__ of the call site
+	unsigned short Line;								// __LINE__ of the call site
+	unsigned short bListed;								// already linked into the drop list
+	unsigned long Drops;								// messages dropped at this site
+	struct pxd_site_t * psNext;
+} pxd_site_t;
+
 typedef	union __attribute__((packed)) xpc_t {
 	xpc_flg_t flg;
 	xpc_val_t val;
 	unsigned long long u64XPC;					// used by XPC_SAVE & XPC_REST
 } xpc_t;
 
+/* "&&" matrix layout, eg "%&&hd" with a pointer to this and a pointer to element [0][0] */
+typedef struct xpmatrix_t {
+	unsigned short Rows;
+	unsigned short Cols;
+	unsigned short Stride;							// bytes from row to row, 0 for Cols elements
+	char cCol;										// between columns, 0 for ','
+	const char * pcRow;								// between rows, NULL for strNL
+} xpmatrix_t;
+
+/* Batch timestamp output layout, see xPrintfxTimeBatch() */
+typedef struct xptlayout_t {
+	const char * pcPre;								// before each stamp eg "\"", NULL for none
+	const char * pcPost;							// after each stamp eg "\",\n", NULL for none
+	int Options;									// xpt* flags
+} xptlayout_t;
+
+/* Streaming hexdump cursor, caller allocated, see xPrintfxDumpBegin() */
+typedef struct xpdump_t {
+	int (* Read)(void * pvPara, unsigned long Offset, void * pvBuf, int Len);	// NULL = memory mapped
+	void * pvPara;									// Read() context, or the data if Read is NULL
+	uintptr_t Addr;									// address displayed for offset 0
+	unsigned long Len;								// bytes to dump
+	unsigned long Offset;							// next byte to dump
+	xpc_t sXPC;										// %Y flags equivalent of the options
+	unsigned short Width;							// bytes per line
+	unsigned short BufLen;							// bytes prefetched into caBuf
+	unsigned short BufOfs;							// next byte to use in caBuf
+	unsigned long Dups;								// duplicate lines pending, xpdSQUEEZE
+	unsigned char caPrev[xpfMAXWIDTH_HEXDUMP];		// previous line, xpdSQUEEZE
+	unsigned char caBuf[xpfDUMP_BLOCK];
+} xpdump_t;
+
 /* Example of bDebug flag usage
  * IF_PX(psXP->ctl.bDebug, "[%.*s", Len, Buffer);
  * IF_PX(psXP->ctl.bDebug, " %.*s", Len, Buffer);
@@ -330,12 +429,30 @@ typedef	struct xp_t {
 } xp_t;
 static_assert(sizeof(xp_t) == (2 * sizeof(void *)) + sizeof(unsigned long) + sizeof(unsigned long long) + sizeof(va_list), "Invalid structure size");
 
+/* %C attribute state of ONE output stream, owned by the caller, see xPrintFXState() */
+typedef struct xpsgr_t {
+	unsigned short Attrib;								// last attribute pair sent
+	unsigned char bValid;								// 0 = unknown, next pair always sent
+} xpsgr_t;
+
+#define	xpfSGR_FORGET(psSGR)		((psSGR)->bValid = 0)
+
 // ################################### Public variables ############################################
 
 // ################################### Public functions ############################################
 
 #if defined(printfxVER0)
 	int xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * pcFmt, va_list vaList);
+
+	/**
+	 * @brief	as xPrintFX() with the %C attribute state of the destination stream kept across calls
+	 * @param	psSGR stream state, NULL for xPrintFX() behaviour (state kept for this call only)
+	 * @note	An attribute pair already in effect on the stream is not sent again. Anything else that
+	 *			changes the stream attributes (esp_log colours, a new telnet session on the same socket,
+	 *			a terminal reset) must be followed by xpfSGR_FORGET(). Calls sharing one state must be
+	 *			serialised by the caller, eg under the console lock.
+	 */
+	int xPrintFXState(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, xpsgr_t * psSGR, const char * pcFmt, va_list vaList);
 #elif defined(printfxVER1)
 	int xPrintFX(int (Hdlr)(xp_t *, const char *, size_t), void * pvPara, size_t Size, const char * pcFmt, va_list vaList);
 #endif
@@ -368,6 +485,18 @@ void vPrintfEdgeTest(void);
  */
 void vPrintfSpeedTest(u32_t Loops);
 
+/**
+ * @brief	nested printfx test, xpfNEST_DEPTH levels deep, checks emit order and per level latency
+ */
+void vPrintfNestTest(void);
+
+/* Called from the stage handler mid-render, after each block of characters is stored, with the
+ * nesting depth as parameter */
+extern void (* pfPrintfxNestHook)(int Depth);
+
+/* Staged blocks and streamed dump lines go here instead of the uart while set */
+extern void (* pfPrintfxWriteHook)(const char * pcBuf, size_t Len);
+
 #endif	// printfxTESTS
 
  // #################################### Destination handlers #######################################
@@ -385,6 +514,89 @@ void vPrintfSpeedTest(u32_t Loops);
 int vprintfx(const char *, va_list)		_ATTRIBUTE ((__format__ (__printf__, 1, 0)));
 int printfx(const char *, ...);			//_ATTRIBUTE ((__format__ (__printf__, 1, 2)));
 
+/**
+ * @brief	deadline bounded printfx, see PXD and route rule 6
+ * @param	psSite call site drop counter, NULL if not tracked
+ * @param	Deadline absolute halTIMER_ReadRunTime() value (uSec) after which the message is dropped
+ * @return	number of characters output or xpfDROPPED
+ */
+int vtprintfx(pxd_site_t * psSite, unsigned long long Deadline, const char *, va_list);
+int tprintfx(pxd_site_t * psSite, unsigned long long Deadline, const char *, ...);
+
+/**
+ * @brief	list every PXD call site that has dropped one or more messages
+ * @param	bReset clear the counters after listing
+ */
+void vPrintfxDropReport(int bReset);
+
+// ########################### Destination = STDOUT, streaming hexdump ############################
+
+/**
+ * @brief	start a streaming hexdump, nothing is output until xPrintfxDumpStep()
+ * @param	psD cursor, caller allocated, in use until xPrintfxDumpStep() returns 0
+ * @param	Options xpd* flags
+ * @param	Width bytes per line, 8 to xpfMAXWIDTH_HEXDUMP, 0 = fit to the console as %Y does
+ * @param	Len bytes to dump
+ * @param	Addr address displayed for offset 0, ignored with xpdREL
+ * @param	Read data source callback, returns bytes read or erFAILURE. NULL if memory mapped
+ * @param	pvPara Read() context or, if Read is NULL, the data itself
+ * @return	number of lines the dump will take, erFAILURE if the parameters are invalid
+ */
+int xPrintfxDumpBegin(xpdump_t * psD, int Options, int Width, unsigned long Len, uintptr_t Addr,
+					int (* Read)(void *, unsigned long, void *, int), void * pvPara);
+
+/**
+ * @brief	output the next lines of a streaming hexdump, the console is locked per line only
+ * @param	psD cursor from xPrintfxDumpBegin()
+ * @param	Lines maximum lines to output in this step
+ * @return	lines still to be output, 0 when complete, erFAILURE if Read() failed
+ * @note	Call from a loop that yields (or does other work) between steps
+ */
+int xPrintfxDumpStep(xpdump_t * psD, int Lines);
+
+/**
+ * @brief	terminate a streaming hexdump, complete or not
+ */
+void vPrintfxDumpEnd(xpdump_t * psD);
+
+/**
+ * @brief	take the console (uart) lock, recording this task as the owner
+ * @param	Ticks maximum wait
+ * @return	1 if taken by this call, 0 if already held by this task or timed out
+ * @note	Pair with vPrintfxUartUnLock(), only the call that took the lock releases it
+ */
+int xPrintfxUartLock(unsigned int Ticks);
+void vPrintfxUartUnLock(int bTaken);
+
+/**
+ * @brief	check if the calling task holds the console lock, taken through xPrintfxUartLock()
+ */
+int xPrintfxUartOwned(void);
+
+/**
+ * @brief	set the local time zone rules used by '+' on %D, %T and %Z
+ * @param	pcTZ POSIX TZ string eg "SAST-2" or "CET-1CEST,M3.5.0,M10.5.0/3", NULL or "" to clear
+ * @param	Year transitions are expanded for xpfTZ_YEARS years centred on this year
+ * @return	erSUCCESS or erFAILURE if the string or year is invalid, current rules unchanged
+ * @note	While set, overrides the tsz_t pTZ offsets. Safe against concurrent printfx callers, but
+ *			not against a concurrent xPrintfxZoneSet(). Call at startup and again around new year.
+ */
+int xPrintfxZoneSet(const char * pcTZ, int Year);
+
+/**
+ * @brief	format a run of uSec timestamps, eg RTC log or sensor history export to CSV or JSON
+ * @param	psL output layout
+ * @param	pu64 timestamps, sorted ascending for speed, any order is still correct
+ * @param	Count number of timestamps
+ * @param	pcBuf output buffer, NUL terminated. With Sink the block output is staged in
+ * @param	Size buffer size, must fit the longest stamp with pcPre and pcPost
+ * @param	Sink called with each full block, returns < 0 to abort. NULL = output to pcBuf only
+ * @param	pvPara Sink() context
+ * @return	timestamps output, less than Count if pcBuf is full, erFAILURE if invalid or aborted
+ */
+int xPrintfxTimeBatch(const xptlayout_t * psL, const unsigned long long * pu64, int Count,
+					char * pcBuf, size_t Size, int (* Sink)(void * pvPara, const char * pcStr, int Len), void * pvPara);
+
 // ##################################### Destination = STRING ######################################
 
 int vsnprintfx(char *, size_t, const char *, va_list)	_ATTRIBUTE ((__format__ (__printf__, 3, 0)));
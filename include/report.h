@@ -205,8 +205,9 @@ typedef struct __attribute__((packed)) report_t {
 		};
 	};
 	fm_t sFM;
+	xpsgr_t * psSGR;									// %C state of the stream, caller owned, NULL = per call
 } report_t;
-DUMB_STATIC_ASSERT(sizeof(report_t) == ((3 * sizeof(void *)) + 8));
+DUMB_STATIC_ASSERT(sizeof(report_t) == ((4 * sizeof(void *)) + 8));
 
 // ################################### Public functions ############################################
 
@@ -231,6 +231,13 @@ void vPrintfUnitTest(void) {
 	for (int idx = 0; idx < 16; ++idx) {
 		TESTP("\nDUMP relative lc BYTE %!+hhY", idx, DumpData);
 	}
+
+	xpdump_t sDump;										// streaming form, memory mapped, 2 lines per step
+	TESTP("\nDUMP streamed relative byte\n");
+	xPrintfxDumpBegin(&sDump, xpdREL | xpdGROUP | xpdASCII, 16, DUMPSIZE, 0, NULL, DumpData);
+	while (xPrintfxDumpStep(&sDump, 2) > 0)
+		vTaskDelay(1);
+	vPrintfxDumpEnd(&sDump);
 	#endif
 
 	#if	(TEST_WIDTH_PREC == 1)
@@ -381,12 +388,107 @@ static u32_t prtestPass, prtestFail;
 	}																		\
 } while (0)
 
+#define prtestTRUE(cond) do {												\
+	if (cond) {																\
+		++prtestPass;														\
+	} else {																\
+		++prtestFail;														\
+		PX("  FAIL  %s" strNL, #cond);										\
+	}																		\
+} while (0)
+
 #define prtestDUMP(fmt, ...) do {											\
 	char caBuf[128];														\
 	int iLen = snprintfx(caBuf, sizeof(caBuf), fmt, ##__VA_ARGS__);			\
 	PX("  %-22s [%3d] '%s'" strNL, fmt, iLen, caBuf);						\
 } while (0)
 
+/* %C attribute state is per call or per stream (psSGR), string destinations send no SGR, so a
+ * collecting handler stands in for a terminal. Output is compared against the escapes expected. */
+static char prtestSGRBuf[128];
+static int prtestSGRLen;
+
+static int prtestSGRHdlr(xp_t * psXP, int iChr) {
+	if (prtestSGRLen < sizeof(prtestSGRBuf) - 1)
+		prtestSGRBuf[prtestSGRLen++] = iChr;
+	return iChr;
+}
+
+static void prtestSGR(xpsgr_t * psSGR, const char * pcFmt, ...) {
+	va_list vaList;
+	va_start(vaList, pcFmt);
+	xPrintFXState(prtestSGRHdlr, NULL, (size_t) sgrANSI << 30, psSGR, pcFmt, vaList);
+	va_end(vaList);
+}
+
+/* Staged printfx()/tprintfx(), the write hook collects the emitted blocks instead of the uart. A
+ * message beyond the stage block spills into chained pool blocks, beyond stage + pool printfx()
+ * flushes early and keeps the lock, tprintfx() truncates. The source is position coded, so a block
+ * out of order or repeated cannot compare equal. */
+#define	prtestSTAGE_MAX		3072
+
+static char prtestStageSrc[prtestSTAGE_MAX], prtestStageOut[prtestSTAGE_MAX];
+static int prtestStageLen, prtestStageFree;			// collected, blocks written without the lock
+
+static void prtestStageHook(const char * pcBuf, size_t Len) {
+	if (xPrintfxUartOwned() == 0)
+		++prtestStageFree;
+	if (Len > sizeof(prtestStageOut) - prtestStageLen)
+		Len = sizeof(prtestStageOut) - prtestStageLen;
+	memcpy(prtestStageOut + prtestStageLen, pcBuf, Len);
+	prtestStageLen += Len;
+}
+
+static void prtestStage(const char * pcTag, int bDeadline, int Len, int Exp) {
+	prtestStageLen = prtestStageFree = 0;
+	pfPrintfxWriteHook = prtestStageHook;				// no PX() until removed
+	int iRV = bDeadline ? tprintfx(NULL, halTIMER_ReadRunTime() + 1000000ULL, "%.*s", Len, prtestStageSrc)
+						: printfx("%.*s", Len, prtestStageSrc);
+	pfPrintfxWriteHook = NULL;
+	if (iRV == Exp && prtestStageLen == Exp && prtestStageFree == 0 && memcmp(prtestStageOut, prtestStageSrc, Exp) == 0) {
+		++prtestPass;
+	} else {
+		++prtestFail;
+		PX("  FAIL  %s %d -> %d/%d unlocked %d  expected %d" strNL, pcTag, Len, iRV, prtestStageLen, prtestStageFree, Exp);
+	}
+}
+
+/* Streamed hexdump, a Read() backed source of a length that is not a multiple of the prefetch
+ * block, collected through the write hook and compared against %Y of the same bytes. */
+#define	prtestDUMP_LEN		(xpfDUMP_BLOCK + 44)
+
+static char prtestDumpExp[2048];
+static unsigned long prtestDumpNext;					// Offset the next Read() must ask for
+static int prtestDumpReads;
+
+static int prtestDumpRead(void * pvPara, unsigned long Offset, void * pvBuf, int Len) {
+	if (Offset != prtestDumpNext)
+		return erFAILURE;
+	memcpy(pvBuf, (const char *) pvPara + Offset, Len);
+	prtestDumpNext += Len;
+	++prtestDumpReads;
+	return Len;
+}
+
+static void prtestDumpStream(void) {
+	const char * pcData = prtestStageSrc + 1;			// odd start, nothing aligned
+	int Exp = snprintfx(prtestDumpExp, sizeof(prtestDumpExp), "%!'+16hhY", prtestDUMP_LEN, pcData);
+	xpdump_t sDump;
+	prtestStageLen = prtestStageFree = prtestDumpReads = prtestDumpNext = 0;
+	int iRV = xPrintfxDumpBegin(&sDump, xpdREL | xpdGROUP | xpdASCII, 16, prtestDUMP_LEN, 0, prtestDumpRead, (void *) pcData);
+	pfPrintfxWriteHook = prtestStageHook;				// no PX() until removed
+	while (iRV > 0)
+		iRV = xPrintfxDumpStep(&sDump, 3);
+	pfPrintfxWriteHook = NULL;
+	if (iRV == 0 && prtestDumpNext == prtestDUMP_LEN && prtestDumpReads == 2 && prtestStageLen == Exp &&
+		prtestStageFree == 0 && memcmp(prtestStageOut, prtestDumpExp, Exp) == 0) {
+		++prtestPass;
+	} else {
+		++prtestFail;
+		PX("  FAIL  dump stream -> %d read %lu in %d, %d/%d chars" strNL, iRV, prtestDumpNext, prtestDumpReads, prtestStageLen, Exp);
+	}
+}
+
 void vPrintfEdgeTest(void) {
 	prtestPass = prtestFail = 0;
 	PX(strNL "[edge] ASSERTED - unambiguous C semantics, a FAIL here is a real defect" strNL);
@@ -423,6 +525,222 @@ void vPrintfEdgeTest(void) {
 	prtestASSERT("42       ", "%-9llu", 42ULL);
 	prtestASSERT("4294967296", "%5llu", (u64_t) UINT32_MAX + 1ULL);	// width < natural length
 
+	// pointer classification, region map lookup
+	prtestASSERT(strNULL, "%s", (char *) NULL);
+	// relative time prefix cache: full render, same second, same minute, minute and day rollover
+	prtestASSERT("1:02:03.456", "%!.3R", 3723456789ULL);
+	prtestASSERT("1:02:03.999", "%!.3R", 3723999999ULL);
+	prtestASSERT("1:02:04.000001", "%!.6R", 3724000001ULL);
+	prtestASSERT("1:02:59.9", "%!.1R", 3779999999ULL);
+	prtestASSERT("1:03:00.00", "%!.2R", 3780000000ULL);
+	prtestASSERT("1T0:00:00.000", "%!.3R", 86400000000ULL);
+	prtestASSERT("5.123", "%!.3R", 5123456ULL);
+
+	// absolute date & time, fixed width template and the ' separator set
+	prtestASSERT("2017-09-10T12:34:56.789", "%.3R", 1505046896789012ULL);
+	prtestASSERT("Sun, 10 Sep 2017-12:34:56", "%#R", 1505046896789012ULL);
+	prtestASSERT("2017/09/10 12h34m56.789012s", "%'.6R", 1505046896789012ULL);
+	prtestASSERT("2000-02-29T23:59:59", "%r", 951868799UL);		// leap day, century
+	prtestASSERT("2106-02-07T06:28:15", "%r", UINT32_MAX);			// last 32-bit second
+
+	// local time zone rules, either side of the CEST -> CET and EST -> EDT transitions
+	tsz_t sZone = { .usecs = 1509238799000000ULL, .pTZ = NULL };
+	xPrintfxZoneSet("CET-1CEST,M3.5.0,M10.5.0/3", 2017);
+	prtestASSERT("2017-10-29T02:59:59+02:00(CEST)", "%+Z", &sZone);
+	sZone.usecs += 1000000ULL;
+	prtestASSERT("2017-10-29T02:00:00+01:00(CET)", "%+Z", &sZone);
+	prtestASSERT("2017/10/29 02h00m00s+01h00(CET)", "%+'Z", &sZone);
+	prtestASSERT("Sun, 29 Oct 2017-01:00:00Z", "%+#Z", &sZone);	// alt form stays UTC
+	xPrintfxZoneSet("EST5EDT,M3.2.0,M11.1.0", 2017);
+	sZone.usecs = 1489301999000000ULL;
+	prtestASSERT("01:59:59", "%+T", &sZone);
+	sZone.usecs += 1000000ULL;
+	prtestASSERT("2017-03-12T03:00:00-04:00(EDT)", "%+Z", &sZone);
+	xPrintfxZoneSet("<+0530>-5:30", 2017);
+	prtestASSERT("2017-03-12T12:30:00+05:30(+0530)", "%+Z", &sZone);
+	xPrintfxZoneSet(NULL, 0);
+
+	// batch timestamps, date part across midnight then a 30 second step
+	u64_t u64Stamps[3] = { 86399500000ULL, 86400250000ULL, 86430999999ULL };
+	xptlayout_t sLayout = { "\"", "\",", xptZULU | 3 };
+	char caBatch[160];
+	xPrintfxTimeBatch(&sLayout, u64Stamps, 3, caBatch, sizeof(caBatch), NULL, NULL);
+	prtestASSERT("\"1970-01-01T23:59:59.500Z\",\"1970-01-02T00:00:00.250Z\",\"1970-01-02T00:00:30.999Z\",", "%s", caBatch);
+
+	// IP addresses, IPv4 octet table and IPv6 RFC 5952 compression
+	u8_t u8IPv6[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1 };
+	prtestASSERT("192.168.  0.  1", "%#I", 0x0100A8C0UL);
+	prtestASSERT("192.168.0.1", "%#-I", 0x0100A8C0UL);
+	prtestASSERT("192.168.000.001", "%#0I", 0x0100A8C0UL);
+	prtestASSERT("2001:db8::1:0:0:1", "%llI", u8IPv6);			// first of 2 equal runs
+	memset(u8IPv6, 0, 16);
+	prtestASSERT("::", "%llI", u8IPv6);
+	u8IPv6[15] = 1;
+	prtestASSERT("::1", "%llI", u8IPv6);
+	u8IPv6[10] = u8IPv6[11] = 0xFF;
+	prtestASSERT("::ffff:0.0.0.1", "%llI", u8IPv6);			// IPv4 mapped
+
+	// URL encoding, safe runs as blocks, escapes from the table, length bounded binary
+	const u8_t u8URL[6] = { 0x00, 'a', 0x2F, 0xC3, 0xA9, 0xFF };
+	prtestASSERT("a%20b%2fc~d-e_f.g", "%U", "a b/c~d-e_f.g");
+	prtestASSERT("h%c3%a9llo%3fq%3d1%26r%3d2", "%U", "h\xC3\xA9llo?q=1&r=2");
+	prtestASSERT("%00a%2f%c3%a9%ff", "%.*U", 6, u8URL);
+	prtestASSERT("%00a", "%.2U", u8URL);
+
+	// Base64, standard and URL safe, padding, justification and whole quad truncation
+	const u8_t u8B64[6] = { 'f', 'o', 'o', 0xFB, 0xFF, 0xBF };
+	prtestASSERT("", "%W", 0, u8B64);
+	prtestASSERT("Zg==", "%W", 1, u8B64);
+	prtestASSERT("Zm8=", "%W", 2, u8B64);
+	prtestASSERT("Zm9v", "%.3W", u8B64);
+	prtestASSERT("Zm9v+/+/", "%W", 6, u8B64);
+	prtestASSERT("Zm9v-_-_", "%#W", 6, u8B64);
+	prtestASSERT("Zm9v-w", "%#W", 4, u8B64);
+	prtestASSERT("[    Zm8=]", "[%8W]", 2, u8B64);
+	prtestASSERT("[Zm8=    ]", "[%-8W]", 2, u8B64);
+	char caB64[8];
+	snprintfx(caB64, sizeof(caB64), "%W", 6, u8B64);
+	prtestASSERT("Zm9v", "%s", caB64);						// 7 available, 1 whole quad
+	snprintfx(caB64, sizeof(caB64), "%W", -10, u8B64);
+	prtestASSERT("", "%s", caB64);							// negative length, nothing encoded
+	prtestASSERT("[    ]", "[%4W]", -10, u8B64);
+
+	// SGR, an attribute pair already in effect is not sent again within a call, across calls only with stream state
+	char caSGR[96], caOne[64], caRed[16], caOff[16];
+	u32_t sgrRED = xpfCOL(attrRESET, colourFG_RED), sgrOFF = xpfCOL(attrRESET, 0);
+	snprintfx(caRed, ((size_t) sgrANSI << 30) | sizeof(caRed), "%C", sgrRED);
+	snprintfx(caOff, ((size_t) sgrANSI << 30) | sizeof(caOff), "%C", sgrOFF);
+	snprintfx(caSGR, sizeof(caSGR), "%sabc%sd", caRed, caOff);
+	snprintfx(caOne, ((size_t) sgrANSI << 30) | sizeof(caOne), "%Cab%Cc%Cd%C", sgrRED, sgrRED, sgrOFF, sgrOFF);
+	prtestASSERT(caSGR, "%s", caOne);
+	prtestSGRLen = 0;
+	prtestSGR(NULL, "%Cab", sgrRED);
+	prtestSGR(NULL, "%Cc", sgrRED);
+	prtestSGR(NULL, "%Cd", sgrOFF);
+	prtestSGR(NULL, "%C", sgrOFF);
+	prtestSGRBuf[prtestSGRLen] = 0;
+	snprintfx(caSGR, sizeof(caSGR), "%sab%sc%sd%s", caRed, caRed, caOff, caOff);
+	prtestASSERT(caSGR, "%s", prtestSGRBuf);
+	const u8_t u8Old[4] = { 1, 2, 3, 4 }, u8New[4] = { 1, 3, 3, 4 };	// diff sends its own escapes
+	snprintfx(caOne, ((size_t) sgrANSI << 30) | sizeof(caOne), "%C%&.4Y", sgrRED, u8Old, u8New);
+	snprintfx(caSGR, sizeof(caSGR), "%s%sx", caOne, caRed);
+	prtestSGRLen = 0;
+	prtestSGR(NULL, "%C%&.4Y%Cx", sgrRED, u8Old, u8New, sgrRED);
+	prtestSGRBuf[prtestSGRLen] = 0;
+	prtestASSERT(caSGR, "%s", prtestSGRBuf);
+	xpsgr_t sSGR = { 0 };								// caller owned, starts unknown
+	prtestSGRLen = 0;
+	prtestSGR(&sSGR, "%Cab", sgrRED);
+	prtestSGR(&sSGR, "%Cc", sgrRED);					// in effect from previous call, skipped
+	xpfSGR_FORGET(&sSGR);								// stream written behind our back
+	prtestSGR(&sSGR, "%Cd", sgrRED);
+	prtestSGR(&sSGR, "%C%&.4Y", sgrRED, u8Old, u8New);	// diff leaves the stream unknown
+	prtestSGR(&sSGR, "%Cx", sgrRED);
+	prtestSGRBuf[prtestSGRLen] = 0;
+	snprintfx(caOne, ((size_t) sgrANSI << 30) | sizeof(caOne), "%&.4Y", u8Old, u8New);
+	snprintfx(caSGR, sizeof(caSGR), "%sabc%sd%s%sx", caRed, caRed, caOne, caRed);
+	prtestASSERT(caSGR, "%s", prtestSGRBuf);
+
+	// arrays, typed fetch into one output window, single value path for left justified
+	const i16_t i16Arr[4] = { -1, 0, 1234, -32768 };
+	const u8_t u8Arr[3] = { 0, 0x7F, 0xFF };
+	const f32_t f32Arr[3] = { 1.5f, -0.25f, 100.0f };
+	prtestASSERT("-1,0,1234,-32768", "%&hd", 4, i16Arr);
+	prtestASSERT("   -1,    0, 1234,-32768", "%&5hd", 4, i16Arr);
+	prtestASSERT("-1   ,0    ,1234 ,-32768", "%&-5hd", 4, i16Arr);
+	prtestASSERT("00,7F,FF", "%&02hhX", 3, u8Arr);
+	prtestASSERT("1.50,-0.25,100.00", "%&.2f", 3, f32Arr);
+
+	// matrix, "&&" with row layout, strided sub-matrix and '!' row index
+	const i16_t i16Mat[2][3] = { { 1, -2, 3 }, { 40, 50, -600 } };
+	const xpmatrix_t sMat = { .Rows = 2, .Cols = 3 };
+	const xpmatrix_t sSub = { .Rows = 2, .Cols = 2, .Stride = 3 * sizeof(i16_t), .cCol = ' ', .pcRow = " | " };
+	prtestASSERT("1,-2,3" strNL "40,50,-600", "%&&hd", &sMat, i16Mat);
+	prtestASSERT("-2 3 | 50 -600", "%&&hd", &sSub, &i16Mat[0][1]);
+	prtestASSERT("0:    1,  -2,   3" strNL "1:   40,  50,-600", "%!&&4hd", &sMat, i16Mat);
+
+	// array runs packed as "value*count" with '!', raw bytes compared a word at a time
+	const u8_t u8Run[12] = { 0, 0, 0, 0, 0, 0, 0, 7, 0xFF, 0xFF, 0xFF, 0 };
+	prtestASSERT("0*7,7,255*3,0", "%!&hhu", 12, u8Run);
+	prtestASSERT("-1,0,1234,-32768", "%!&hd", 4, i16Arr);
+	prtestASSERT("00*7,07,FF*3,00", "%!&02hhX", 12, u8Run);
+
+	// scaling, scale from the bit length, one 64 bit division, IEC units with '##'
+	prtestASSERT("1.05K", "%#lu", 1050UL);
+	prtestASSERT("1.97T", "%#llu", 1976338079628ULL);
+	prtestASSERT("1.50Ki", "%##lu", 1536UL);
+	prtestASSERT("0.97Mi", "%##lu", 1024000UL);
+	prtestASSERT("  15.999999Ei", "%##13llu", UINT64_MAX);
+	const u32_t u32Mem[4] = { 1536, 1536, 1536, 2048 };			// IEC and run packing chosen apart
+	const xpmatrix_t sMat2 = { .Rows = 2, .Cols = 2 };
+	prtestASSERT("1.50Ki,1.50Ki,1.50Ki,2.00Ki", "%##&lu", 4, u32Mem);
+	prtestASSERT("1.50Ki*3,2.00Ki", "%!##&lu", 4, u32Mem);
+	prtestASSERT("1.50Ki,1.50Ki" strNL "1.50Ki,2.00Ki", "%##&&lu", &sMat2, u32Mem);
+	prtestASSERT("0: 1.50Ki,1.50Ki" strNL "1: 1.50Ki,2.00Ki", "%!##&&lu", &sMat2, u32Mem);
+
+	// fixed point, integer arithmetic only, decimal digits 'q' or fraction bits 'Q'
+	prtestASSERT("21.5", "%q", 2, 2150);
+	prtestASSERT("-0.05", "%.2q", 2, -5);
+	prtestASSERT("1.5", "%Q", 16, 0x00018000);
+	prtestASSERT("   -1.500", "%9.3lQ", 16, -0x00018000L);
+	prtestASSERT(" 1,234,567.9", "%'12.1lq", 3, 1234567891L);
+	prtestASSERT("+0009.90", "%+08.2q", 1, 99);
+	prtestASSERT("10.0", "%.1q", 2, 995);
+	prtestASSERT("1.050   |", "%-8.3q|", 2, 105);
+	prtestASSERT(strOOR "|7", "%q|%d", 20, 1, 7);				// scale out of range, value consumed
+	prtestASSERT(strOOR "|7", "%.2q|%d", -1, 1, 7);
+	prtestASSERT(strOOR "|7", "%lQ|%d", 64, 1L, 7);
+
+	// binary, nibble table with separators at fixed positions, width as the bit count
+	prtestASSERT("0b11110111011111111010010101011010", "%b", 0xF77FA55AUL);
+	prtestASSERT("0b1111-0111 0111-1111:1010-0101 0101-1010", "%'b", 0xF77FA55AUL);
+	prtestASSERT("0b0-0101 0101-1010", "%'13b", 0xF77FA55AUL);
+	prtestASSERT("0B1100-0100 0100-1100:1001-0111 0111-1001|1111-0111 0111-1111:1010-0101 0101-1010", "%'llB", 0xC44C9779F77FA55AULL);
+
+	// JSON/C string escaping, class table, UTF-8 to \uXXXX with '#'
+	prtestASSERT("a\\\"b\\\\c\\n\\u001b", "%J", "a\"b\\c\n\x1B");
+	prtestASSERT("caf\xC3\xA9", "%J", "caf\xC3\xA9");
+	prtestASSERT("caf\\u00e9 \\ud83d\\ude00 \\ufffd", "%#J", "caf\xC3\xA9 \xF0\x9F\x98\x80 \xC3");
+	prtestASSERT("[   \\tx]", "[%6J]", "\tx");
+	prtestASSERT("[\\\"a  ]", "[%-5.2J]", "\"abc");
+
+	// UUID, byte to hex pair table, case from the specifier
+	const u8_t u8UUID[16] = { 0x12, 0x3E, 0x45, 0x67, 0xE8, 0x9B, 0x12, 0xD3, 0xA4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00 };
+	prtestASSERT("123e4567-e89b-12d3-a456-426614174000", "%v", u8UUID);
+	prtestASSERT("123E4567-E89B-12D3-A456-426614174000", "%V", u8UUID);
+	prtestASSERT("[123e4567-e89b-12d3-a456-426614174000  ]", "[%-38v]", u8UUID);
+
+	#if (xpfTRUST_POINTERS == 0)
+	prtestASSERT(strOOR, "%s", (char *) 0xFFFFFFE6);				// intercepted wifi message case
+	#endif
+
+	// staged output, spill chain in order, early flush under the lock, deadline truncation
+	int Stage = xStdStageSize(), Pool = xpfSPILL_BLOCKS * xpfSPILL_SIZE;
+	if (Stage + Pool + 100 <= prtestSTAGE_MAX) {
+		for (int i = 0; i < prtestSTAGE_MAX; ++i)
+			prtestStageSrc[i] = 'A' + (i + i / 26) % 26;
+		prtestStage("printfx spill", 0, Stage + xpfSPILL_SIZE + 10, Stage + xpfSPILL_SIZE + 10);
+		prtestStage("printfx flush", 0, Stage + Pool + 100, Stage + Pool + 100);
+		prtestStage("tprintfx spill", 1, Stage + 10, Stage + 10);
+		prtestStage("tprintfx trunc", 1, Stage + Pool + 100, Stage + Pool);
+	}
+	prtestDumpStream();
+
+	// deadline bounded, expired or lock not available in time => dropped, counted per site
+	static pxd_site_t sSite = { .pcFunc = __FUNCTION__, .Line = __LINE__ };
+	u64_t Now = halTIMER_ReadRunTime();
+	int iExpired = tprintfx(&sSite, Now, "expired");
+	halUartLockOnce(portMAX_DELAY);						// held outside printfx, as another task would
+	int iLocked = tprintfx(&sSite, halTIMER_ReadRunTime() + 2000ULL, "locked");
+	halUartUnLockOnce(pdTRUE);
+	pfPrintfxWriteHook = prtestStageHook;				// no PX() until removed
+	int iSent = tprintfx(&sSite, halTIMER_ReadRunTime() + 1000000ULL, "sent");
+	pfPrintfxWriteHook = NULL;
+	prtestTRUE(iExpired == xpfDROPPED && iLocked == xpfDROPPED && iSent == 4);
+	prtestTRUE(sSite.Drops == 2 && sSite.bListed);
+	vPrintfxDropReport(1);
+	prtestTRUE(sSite.Drops == 0);
+
 	PX("[edge] ASSERTED: %lu passed, %lu FAILED" strNL, prtestPass, prtestFail);
 
 	PX(strNL "[edge] REFERENCE DUMP - proprietary formats, diff before/after a change" strNL);
@@ -444,6 +762,74 @@ void vPrintfEdgeTest(void) {
 	prtestDUMP("%.6f", 0.0);
 	prtestDUMP("%e", 1234.5678);
 	prtestDUMP("%g", 0.000123456);
+	static const u8_t caHex[16] = { 0x00, 0x1F, 0x20, 0x41, 0x7E, 0x7F, 0x80, 0xFF, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+	prtestDUMP("%!'hhY", 16, caHex);								// hexdump line kernel
+	prtestDUMP("%!#'hY", 16, caHex);
+	prtestDUMP("%!+16Y", 16, caHex);
+	static const u8_t caZero[64] = { 0 };
+	prtestDUMP("%0-8hhY", sizeof(caZero), caZero);					// duplicate lines collapsed
+	prtestDUMP("%!&'8hhY", 8, caHex, caHex + 8);						// diff, changed bytes marked
+}
+
+// ###################################### Nested printfx test #######################################
+
+/* Each level's hook calls printfx one level deeper from inside the stage handler, ie while xPrintFX
+ * is mid-render with the outer head block partly filled, down to xpfNEST_DEPTH. Inner messages must
+ * be emitted (and return) first, so the completion order is xpfNEST_DEPTH..0, and the write hook must
+ * see each message whole, in that order. No level may wait on the stage its own task holds, a level
+ * taking anywhere near WPFX_TIMEOUT fell through to the stage wait, ie nesting is broken. */
+
+static u8_t prtestNestOrder[xpfNEST_DEPTH + 1];
+static u8_t prtestNestSeq;
+static u8_t prtestNestDone;								// levels already nested from, 1 bit each
+static int prtestNestLen[xpfNEST_DEPTH + 1];
+static u64_t prtestNestElap[xpfNEST_DEPTH + 1];
+
+static void vPrintfNestHook(int Depth) {
+	if (Depth >= xpfNEST_DEPTH || (prtestNestDone & (1 << Depth)))
+		return;										// called per block stored, nest once per level
+	prtestNestDone |= 1 << Depth;
+	u64_t t0 = halTIMER_ReadRunTime();
+	prtestNestLen[Depth + 1] = printfx("[nest] level %d" strNL, Depth + 1);
+	prtestNestElap[Depth + 1] = halTIMER_ReadRunTime() - t0;
+	prtestNestOrder[prtestNestSeq++] = Depth + 1;
+}
+
+void vPrintfNestTest(void) {
+	prtestPass = prtestFail = 0;
+	prtestNestSeq = prtestNestDone = 0;
+	prtestStageLen = prtestStageFree = 0;
+	pfPrintfxWriteHook = prtestStageHook;				// no PX() until removed
+	pfPrintfxNestHook = vPrintfNestHook;
+	u64_t t0 = halTIMER_ReadRunTime();
+	prtestNestLen[0] = printfx("[nest] level %d" strNL, 0);
+	prtestNestElap[0] = halTIMER_ReadRunTime() - t0;
+	prtestNestOrder[prtestNestSeq++] = 0;
+	pfPrintfxNestHook = NULL;
+	pfPrintfxWriteHook = NULL;
+
+	u64_t tLimit = pdTICKS_TO_MS(WPFX_TIMEOUT) * 1000ULL / 2;	// well short of a stage timeout
+	int iLen = sizeof("[nest] level 0" strNL) - 1;
+	for (int i = 0; i <= xpfNEST_DEPTH; ++i) {
+		int Level = prtestNestOrder[i];
+		if (Level == (xpfNEST_DEPTH - i) && prtestNestLen[Level] == iLen && prtestNestElap[Level] < tLimit) {
+			++prtestPass;
+		} else {
+			++prtestFail;
+			PX("  FAIL  #%d level %d  len %d  %llu uS" strNL, i, Level, prtestNestLen[Level], prtestNestElap[Level]);
+		}
+	}
+	char caExp[(xpfNEST_DEPTH + 1) * sizeof("[nest] level 0" strNL)];
+	int Len = 0;
+	for (int Level = xpfNEST_DEPTH; Level >= 0; --Level)
+		Len += snprintfx(caExp + Len, sizeof(caExp) - Len, "[nest] level %d" strNL, Level);
+	if (prtestStageLen == Len && prtestStageFree == 0 && memcmp(prtestStageOut, caExp, Len) == 0) {
+		++prtestPass;
+	} else {
+		++prtestFail;
+		PX("  FAIL  emitted '%.*s'" strNL, prtestStageLen, prtestStageOut);
+	}
+	PX("[nest] %d levels: %lu passed, %lu FAILED, outer %llu uS" strNL, xpfNEST_DEPTH, prtestPass, prtestFail, prtestNestElap[0]);
 }
 
 // ################################## Conversion speed benchmark ###################################
@@ -469,9 +855,37 @@ static void bs_d7(void)    { snprintfx(prtestBuf, sizeof(prtestBuf), "%d", 33909
 static void bs_u32max(void){ snprintfx(prtestBuf, sizeof(prtestBuf), "%lu", UINT32_MAX); }
 static void bs_u64(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%llu", UINT64_MAX); }
 static void bs_hex(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%X", 0xDEADBEEF); }
+static void bs_bin(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%'llb", 0xC44C9779F77FA55AULL); }
+static void bs_sgr(void)   { prtestSGRLen = 0; prtestSGR(NULL, "%C%s%C ", xpfCOL(attrRESET, 0), "label", 0); }
+static u16_t bsADC[512];
+static void bs_arr(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%&hu", 512, bsADC); }
+static void bs_rle(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%!&hu", 512, bsADC); }
+static const xpmatrix_t bsMat = { .Rows = 16, .Cols = 32 };
+static void bs_mat(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%!&&5hu", &bsMat, bsADC); }
+static void bs_si(void)    { snprintfx(prtestBuf, sizeof(prtestBuf), "%#llu", 1976338079628ULL); }
+static void bs_iec(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%##llu", 5497558138880ULL); }
+static void bs_fix(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%.3lq", 2, 2150L); }
 static void bs_grp(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%'d", 1234567); }
 static void bs_str(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%s", "ds248xReset"); }
 static void bs_flt(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%.3f", 3.14159); }
+static void bs_col(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%-40s|", "ds248xReset"); }
+static void bs_dump(void)  { snprintfx(prtestBuf, sizeof(prtestBuf), "%!'+32Y", 32, prtestBuf); }
+static u64_t bsRunTime = 3723456789ULL;
+static void bs_rel(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%!.3R", bsRunTime += 997); }
+static void bs_abs(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%.3R", bsRunTime + 1505046896789012ULL); }
+static void bs_rfc(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%#R", bsRunTime + 1505046896789012ULL); }
+static u64_t bsStamps[16];
+static const xptlayout_t bsLayout = { NULL, "\n", 3 };
+static int bs_sink(void * pvPara, const char * pcStr, int Len) { return Len; }
+static void bs_batch(void) { xPrintfxTimeBatch(&bsLayout, bsStamps, 16, prtestBuf, sizeof(prtestBuf), bs_sink, NULL); }
+static const u8_t bsIPv6[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x1A, 0x2B, 0xFF, 0xFE, 0x3C, 0x4D, 0x5E };
+static void bs_ip4(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%#-I", 0x0100A8C0UL); }
+static void bs_ip6(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%llI", bsIPv6); }
+static void bs_url(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%U", "sensor/temp_01?unit=degC&from=2017-09-10 12:34"); }
+static void bs_json(void)  { snprintfx(prtestBuf, sizeof(prtestBuf), "%J", "{\"name\":\"ds248x\",\"msg\":\"reset\tOK\"}"); }
+static void bs_b64(void)   { snprintfx(prtestBuf, sizeof(prtestBuf), "%W", 48, (u8_t *) bsStamps); }
+static void bs_uuid(void)  { snprintfx(prtestBuf, sizeof(prtestBuf), "%v", bsIPv6); }
+static void bs_case(void)  { snprintfx(prtestBuf, sizeof(prtestBuf), "%>20s", "DS248XRESET"); }
 static void bs_line(void)  { snprintfx(prtestBuf, sizeof(prtestBuf),
 	"%d %s ds248xReset (%d) Success after %d retries", 0, "i2c_v2", 192, 5); }
 
@@ -503,8 +917,31 @@ void vPrintfSpeedTest(u32_t Loops) {
 	prtestBench("%llu UINT64_MAX",      Loops, bs_u64);
 	prtestBench("%X  hex 32bit",        Loops, bs_hex);
 	prtestBench("%'d grouped",          Loops, bs_grp);
+	prtestBench("%#llu SI scaled",      Loops, bs_si);
+	prtestBench("%##llu IEC scaled",    Loops, bs_iec);
+	prtestBench("%'llb 64 bit binary",  Loops, bs_bin);
+	prtestBench("%C%s%C bitmap label",  Loops, bs_sgr);
+	prtestBench("%&hu 512 ADC samples", Loops / 64, bs_arr);
+	prtestBench("%!&hu 512 packed samples", Loops / 64, bs_rle);
+	prtestBench("%!&&5hu 16x32 matrix",  Loops / 64, bs_mat);
 	prtestBench("%s  11 char string",   Loops, bs_str);
+	prtestBench("%-40s table column",   Loops, bs_col);
+	prtestBench("%>20s lower cased",    Loops, bs_case);
+	prtestBench("%Y  32 byte dump line", Loops, bs_dump);
+	prtestBench("%!.3R _T_ prefix",     Loops, bs_rel);
+	prtestBench("%.3R absolute",        Loops, bs_abs);
+	prtestBench("%#R RFC-1123",         Loops, bs_rfc);
+	for (int i = 0; i < 16; ++i)
+		bsStamps[i] = 1505046896789012ULL + i * 1000000ULL;
+	prtestBench("batch x16 1Hz stamps", Loops / 16, bs_batch);
+	prtestBench("%#-I IPv4",            Loops, bs_ip4);
+	prtestBench("%llI IPv6",            Loops, bs_ip6);
+	prtestBench("%U  46 char URL",      Loops, bs_url);
+	prtestBench("%J  JSON escape",      Loops, bs_json);
+	prtestBench("%W  48 byte Base64",   Loops, bs_b64);
+	prtestBench("%v  UUID",             Loops, bs_uuid);
 	prtestBench("%.3f float",           Loops, bs_flt);
+	prtestBench("%.3lq fixed point",    Loops, bs_fix);
 	prtestBench("full log line",        Loops, bs_line);
 
 	PX(strNL "[speed] S65 specifier vs character cost, all 12 output chars, %lu loops each" strNL, Loops);
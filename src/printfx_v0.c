@@ -27,6 +27,7 @@
 #if defined(ESP_PLATFORM)
 	#include "esp_log.h"
 	#include "esp_rom_crc.h"
+	#include "soc/soc.h"
 #else
 	#include "crc-barr.h"			// Barr group CRC
 #endif
@@ -44,24 +45,34 @@
 #define	xpfSUPPORT_MAC_ADDR			1
 #define	xpfSUPPORT_IP_ADDR			1
 #define	xpfSUPPORT_HEXDUMP			1
-#define	xpfSUPPORT_UUID				0
+#define	xpfSUPPORT_UUID				1
 #define	xpfSUPPORT_DATETIME			1
 #define	xpfSUPPORT_IEEE754			1					// float point support in printfx.c functions
 #define	xpfSUPPORT_SCALING			1					// scale number down by 10^[3/6/9/12/15/18]
 #define	xpfSUPPORT_SGR				1					// Set Graphics Rendition FG & BG colors only
 #define	xpfSUPPORT_URL				1					// URL encoding
+#define	xpfSUPPORT_BASE64			1					// Base64 encoding, standard & URL safe
+#define	xpfSUPPORT_JSON				1					// JSON/C string escaping
+#define	xpfSUPPORT_FIXED			1					// fixed point, integer arithmetic only
 #define	xpfSUPPORT_ALIASES			1
 #define	xpfSUPPORT_FILTER_NUL		1
 #define xpfSUPPORT_ARRAYS			1					// uses complex vars to achieve
 
 // ###################################### Scaling factors ##########################################
 
-#define	K1		1000ULL
-#define	M1		1000000ULL
-#define	B1		1000000000ULL
-#define	T1		1000000000000ULL
-#define	q1		1000000000000000ULL
-#define	Q1		1000000000000000000ULL
+#if	(xpfSUPPORT_SCALING > 0) || (xpfSUPPORT_FIXED == 1)
+/* Scale selected from the bit length: log10(2) ~ 1233/4096 gives the digit count low by at most 1,
+ * corrected with one compare against the table. IEC scales are shifts and need no table. */
+static const u64_t u64Pow10[20] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+	1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+	1000000000000000000ULL, 10000000000000000000ULL,
+};
+#endif
+#if	(xpfSUPPORT_SCALING > 0)
+static const char caScale[2][7] = { "KMBTqQ", "KMGTPE" };	// SI (10^3n) & IEC (2^10n)
+#endif
 
 // ####################################### xpc_t macros ############################################
 
@@ -91,7 +102,80 @@ const char Delim1[2] = { 'T', ' ' };					// "T "
 const char Delim2[2] = { ':', 'h' };					// ":h"
 const char Delim3[2] = { ':', 'm' };					// ":m"
 
+#if	(xpfSUPPORT_DATETIME == 1)
+// "00" to "99", 2 characters per value, for the fixed width date & time fields
+#define	xpD10(t)		t "0" t "1" t "2" t "3" t "4" t "5" t "6" t "7" t "8" t "9"
+static const char caDigits2[200 + 1] = xpD10("0") xpD10("1") xpD10("2") xpD10("3") xpD10("4")
+										xpD10("5") xpD10("6") xpD10("7") xpD10("8") xpD10("9");
+static const char caDayName[7 * 3 + 1] = "SunMonTueWedThuFriSat";
+static const char caMonName[12 * 3 + 1] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+#endif
+
 const char hexchars[] = "0123456789ABCDEF";
+
+// Padding runs, emitted as blocks. Longer pads are emitted as repeated runs
+#define	xpfPAD_RUN					32
+static const char caPadSpace[xpfPAD_RUN] = "                                ";
+static const char caPadZero[xpfPAD_RUN] = "00000000000000000000000000000000";
+
+// C locale case folding, indexed by the unsigned char. Only A-Z/a-z change, like tolower()/toupper()
+#define	xpC4(f, b)		f(b), f(b+1), f(b+2), f(b+3)
+#define	xpC16(f, b)		xpC4(f, b), xpC4(f, b+4), xpC4(f, b+8), xpC4(f, b+12)
+#define	xpC64(f, b)		xpC16(f, b), xpC16(f, b+16), xpC16(f, b+32), xpC16(f, b+48)
+#define	xpLOWER(c)		(u8_t) (((c) >= 'A' && (c) <= 'Z') ? (c) + ('a' - 'A') : (c))
+#define	xpUPPER(c)		(u8_t) (((c) >= 'a' && (c) <= 'z') ? (c) - ('a' - 'A') : (c))
+static const u8_t caToLower[256] = { xpC64(xpLOWER, 0), xpC64(xpLOWER, 64), xpC64(xpLOWER, 128), xpC64(xpLOWER, 192) };
+static const u8_t caToUpper[256] = { xpC64(xpUPPER, 0), xpC64(xpUPPER, 64), xpC64(xpUPPER, 128), xpC64(xpUPPER, 192) };
+// every nibble as 4 binary digits, and the %'b separator in front of each nibble by nibbles remaining
+#define	xpNIBBLE(n)		'0' + (((n) >> 3) & 1), '0' + (((n) >> 2) & 1), '0' + (((n) >> 1) & 1), '0' + ((n) & 1)
+static const char caNibble[16 * 4] = { xpC16(xpNIBBLE, 0) };
+static const char caBinSep[8] = { CHR_VERT_BAR, CHR_MINUS, CHR_SPACE, CHR_MINUS, CHR_COLON, CHR_MINUS, CHR_SPACE, CHR_MINUS };
+#define	xpHEXL(d)		(char) ((d) < 10 ? '0' + (d) : 'a' - 10 + (d))
+#define	xpHEXU(d)		(char) ((d) < 10 ? '0' + (d) : 'A' - 10 + (d))
+
+#if	(xpfSUPPORT_UUID == 1)
+// every byte as 2 hex characters, [0] lower case, [1] upper case
+#define	xpHEX2L(n)		xpHEXL((n) >> 4), xpHEXL((n) & 0xF)
+#define	xpHEX2U(n)		xpHEXU((n) >> 4), xpHEXU((n) & 0xF)
+static const char caHex2[2][256 * 2] = {
+	{ xpC64(xpHEX2L, 0), xpC64(xpHEX2L, 64), xpC64(xpHEX2L, 128), xpC64(xpHEX2L, 192) },
+	{ xpC64(xpHEX2U, 0), xpC64(xpHEX2U, 64), xpC64(xpHEX2U, 128), xpC64(xpHEX2U, 192) },
+};
+#endif
+
+#if	(xpfSUPPORT_BASE64 == 1)
+// RFC 4648 alphabets, [0] standard, [1] URL and filename safe
+static const char caBase64[2][64] = {
+	{ 'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z',
+	  'a','b','c','d','e','f','g','h','i','j','k','l','m','n','o','p','q','r','s','t','u','v','w','x','y','z',
+	  '0','1','2','3','4','5','6','7','8','9','+','/' },
+	{ 'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z',
+	  'a','b','c','d','e','f','g','h','i','j','k','l','m','n','o','p','q','r','s','t','u','v','w','x','y','z',
+	  '0','1','2','3','4','5','6','7','8','9','-','_' },
+};
+#endif
+
+#if	(xpfSUPPORT_JSON == 1)
+// JSON string escape class for every byte, 0 = as is, 1 = non-ASCII, 'u' = "\u00xx", else the "\?" letter
+#define	xpJSON(c)		(u8_t) ((c) == '"' ? '"' : (c) == '\\' ? '\\' : (c) == '\b' ? 'b' : (c) == '\f' ? 'f' :	\
+						(c) == '\n' ? 'n' : (c) == '\r' ? 'r' : (c) == '\t' ? 't' : (c) < 0x20 ? 'u' : (c) >= 0x80 ? 1 : 0)
+static const u8_t caJSON[256] = { xpC64(xpJSON, 0), xpC64(xpJSON, 64), xpC64(xpJSON, 128), xpC64(xpJSON, 192) };
+#endif
+
+#if	(xpfSUPPORT_URL == 1)
+// RFC 3986 unreserved characters A-Z a-z 0-9 - . _ ~ as a bitmap, and the "%xx" escape for every byte
+static const u32_t caURLSafe[8] = { 0, 0x03FF6000, 0x87FFFFFE, 0x47FFFFFE, 0, 0, 0, 0 };
+#define	xpURL_SAFE(c)	((caURLSafe[(c) >> 5] >> ((c) & 0x1F)) & 1)
+#define	xpESCAPE(n)		'%', xpHEXL((n) >> 4), xpHEXL((n) & 0xF)
+static const char caURLEscape[256 * 3] = { xpC64(xpESCAPE, 0), xpC64(xpESCAPE, 64), xpC64(xpESCAPE, 128), xpC64(xpESCAPE, 192) };
+#endif
+
+#if	(xpfSUPPORT_IP_ADDR == 1)
+// IPv4 octets "000" to "255", zero padded, 4th byte the length without leading zeros
+#define	xpOCTET(n)		(char) ('0' + (n) / 100), (char) ('0' + (n) / 10 % 10), (char) ('0' + (n) % 10), \
+						(char) (1 + ((n) >= 10) + ((n) >= 100))
+static const char caOctet[256 * 4] = { xpC64(xpOCTET, 0), xpC64(xpOCTET, 64), xpC64(xpOCTET, 128), xpC64(xpOCTET, 192) };
+#endif
 const char vPrintStr1[] = {			// table of characters where lc/UC is applicable
 	'B',							// Binary formatted, prepend "0b" or "0B"
 	'P',							// pointer formatted, 0x00abcdef or 0X00ABCDEF
@@ -99,6 +183,12 @@ const char vPrintStr1[] = {			// table of characters where lc/UC is applicable
 	'R',							// Time, absolute/relative, no ZONE info, 64bit/uSec or 32bit/Sec
 	#endif
 	'X',							// hex formatted 'x' or 'X' values, always there
+	#if	(xpfSUPPORT_UUID == 1)
+	'V',							// UUID, 'v' lower or 'V' upper case hex
+	#endif
+	#if	(xpfSUPPORT_FIXED == 1)
+	'Q',							// fixed point, 'q' decimal or 'Q' binary fraction
+	#endif
 	#if	(xpfSUPPORT_IEEE754 == 1)
 	'A', 'E', 'F', 'G',				// float hex/exponential/general
 	#endif
@@ -216,6 +306,50 @@ static int xPrintChar(xp_t * psXP, char cChr) {
 	return iRV;
 }
 
+static int xPrintToStage(xp_t *, int);
+static size_t xPrintStageChars(xp_t *, const char *, size_t);
+
+/**
+ * @brief	output a block of characters, same result as calling xPrintChar() for each
+ * @param	psXP - pointer to control structure to be referenced/updated
+ * @param	pcSrc - characters to be output, must not contain '\000'
+ * @param	Len - number of characters
+ * @note	Uses MaxLen and CurLen
+ * @note	Changes CurLen
+ * @note	String and stage handlers are fed with block copies, all others one character at a time
+ */
+static void xPrintChars(xp_t * psXP, const char * pcSrc, size_t Len) {
+	if (psXP->MaxLen && (psXP->CurLen + Len > psXP->MaxLen))
+		Len = (psXP->CurLen < psXP->MaxLen) ? psXP->MaxLen - psXP->CurLen : 0;
+	if (psXP->hdlr == xPrintToString) {
+		if (psXP->pvPara) {
+			memcpy(psXP->pvPara, pcSrc, Len);
+			psXP->pvPara = (char *) psXP->pvPara + Len;
+		}
+		psXP->CurLen += Len;
+	} else if (psXP->hdlr == xPrintToStage) {
+		psXP->CurLen += xPrintStageChars(psXP, pcSrc, Len);
+	} else {
+		while (Len--)
+			xPrintChar(psXP, *pcSrc++);
+	}
+}
+
+/**
+ * @brief	output Len copies of a padding character, in blocks
+ * @param	psXP - pointer to control structure to be referenced/updated
+ * @param	cPad - CHR_SPACE or CHR_0
+ * @param	Len - number of pad characters
+ */
+static void vPrintPadding(xp_t * psXP, char cPad, size_t Len) {
+	const char * pcRun = (cPad == CHR_0) ? caPadZero : caPadSpace;
+	while (Len) {
+		size_t Now = (Len < xpfPAD_RUN) ? Len : xpfPAD_RUN;
+		xPrintChars(psXP, pcRun, Now);
+		Len -= Now;
+	}
+}
+
 /**
  * @brief	perform a RAW string output to the selected "stream"
  * @brief	Does not perform ANY padding, justification or length checking
@@ -244,7 +378,7 @@ static int vPrintString(xp_t * psXP, char * pStr) {
  * @note	Changes CurLen indirectly through xPrintChar
  * @return	number of ACTUAL characters output.
  */
-static void vPrintStringJustified(xp_t * psXP, char * pStr) {
+static void vPrintStringJustified(xp_t * psXP, const char * pStr) {
 	// determine natural or limited length of string
 	size_t uLen;
 	if (psXP->flg.bPrecis && psXP->flg.bMinWid && (psXP->flg.Precis <= psXP->flg.MinWid)) {
@@ -267,10 +401,24 @@ static void vPrintStringJustified(xp_t * psXP, char * pStr) {
 		}
 	}
 	u8_t Cpad = psXP->flg.bPad0 ? CHR_0 : CHR_SPACE;
-	for (;Lpad--; xPrintChar(psXP, Cpad));				/* output Left pad characters */
-	for (;uLen-- && *pStr; ++pStr)
-		xPrintChar(psXP, psXP->flg.bGT ? tolower(*pStr) : psXP->flg.bLT ? toupper(*pStr) : *pStr);
-	for (;Rpad--; xPrintChar(psXP, Cpad));				/* output Right pad characters */
+	if (Lpad)
+		vPrintPadding(psXP, Cpad, Lpad);
+	uLen = xstrnlen(pStr, uLen);						// body, as emitted, stops at the terminator
+	if (psXP->flg.bGT || psXP->flg.bLT) {				// case folded through a bounce buffer
+		const u8_t * pcCase = psXP->flg.bGT ? caToLower : caToUpper;
+		char caBuf[xpfPAD_RUN];
+		while (uLen) {
+			size_t Now = (uLen < sizeof(caBuf)) ? uLen : sizeof(caBuf);
+			for (size_t i = 0; i < Now; ++i)
+				caBuf[i] = pcCase[(u8_t) *pStr++];
+			xPrintChars(psXP, caBuf, Now);
+			uLen -= Now;
+		}
+	} else if (uLen) {
+		xPrintChars(psXP, pStr, uLen);
+	}
+	if (Rpad)
+		vPrintPadding(psXP, Cpad, Rpad);
 }
 
 /**
@@ -281,13 +429,14 @@ static void vPrintStringJustified(xp_t * psXP, char * pStr) {
  * @param	BufSize - available (remaining) space in buffer
  * @return	number of actual characters output (incl leading '-' and/or ' ' and/or '0' as possibly added)
  * @note	Honour & interpret the following modifiers
- * @note	'#' Enable scaling in SI units
+ * @note	'#' Enable scaling in SI units, decimal values only
+ * @note	'##' Scale in IEC units (Ki Mi Gi Ti Pi Ei), steps of 1024
  * @note	''' If scaling select bGroup = 0/1 columns below.
  * @note		If not scaling group digits in 3's (3rd column below)
  * @note	'-' Left align the individual numbers between the '.'
  * @note	'+' Force a '+' or '-' sign on the left
  * @note	'0' Zero pad to the left of the value to fill the field
- * @note	Uses bAltF bGroup uBase bLeft bPad0 bNegVal bPlus MinWid
+ * @note	Uses bAltF bIEC bGroup uBase bLeft bPad0 bNegVal bPlus MinWid
  * @note	Changes nothing
  * @note	Buffer overflow if incorrect BufSize allocated in calling function
 */
@@ -317,41 +466,73 @@ static int	xPrintValueJustified(xp_t * psXP, u64_t u64Val, char * pBuffer, int B
 		 *	1.234K		1K234		1,234
 		 *	123			123			123
 		*/
-		if (psXP->flg.bAltF) {
-			u32_t I, F;
-			u8_t ScaleChr;
-			if (u64Val >= Q1)		{ F = u64Val % Q1; I = u64Val / Q1; ScaleChr = CHR_Q; }
-			else if (u64Val >= q1)	{ F = u64Val % q1; I = u64Val / q1; ScaleChr = CHR_q; }
-			else if (u64Val >= T1)	{ F = u64Val % T1; I = u64Val / T1; ScaleChr = CHR_T; }
-			else if (u64Val >= B1)	{ F = u64Val % B1; I = u64Val / B1; ScaleChr = CHR_B; }
-			else if (u64Val >= M1)	{ F = u64Val % M1; I = u64Val / M1; ScaleChr = CHR_M; }
-			else if (u64Val >= K1)	{ F = u64Val % K1; I = u64Val / K1; ScaleChr = CHR_K; }
-			else { ScaleChr = 0; }
-			if (ScaleChr) {
-				if (psXP->flg.bGroup == 0) {
-					*pTemp-- = ScaleChr;
+		if (psXP->flg.bAltF && psXP->flg.uBase == 10 && u64Val >= u64Pow10[3]) {
+			int IEC = psXP->flg.bIEC, Bits = 64 - __builtin_clzll(u64Val);
+			int Scale, Ilen, Fmax;						// Scale 1 (K/Ki) -> 6 (Q/Ei)
+			if (IEC) {									// 1000 and above moves to the next unit
+				Scale = (Bits - 1) / 10;
+				if (Scale == 0 || (Scale < 6 && (u64Val >> (Scale * 10)) >= u64Pow10[3]))
+					++Scale;
+				u32_t I = u64Val >> (Scale * 10);
+				Ilen = (I < 10) ? 1 : (I < 100) ? 2 : 3;
+				Fmax = (Scale < 2) ? 3 : 6;
+			} else {
+				int Digits = (Bits * 1233) >> 12;		// 1 (1) -> 20 (UINT64_MAX)
+				Digits += (u64Val >= u64Pow10[Digits]);
+				Scale = (Digits - 1) / 3;
+				Ilen = Digits - Scale * 3;
+				Fmax = Scale * 3;
+			}
+			// if field width has been specified, use that as base, adjusted for scaling character(s)
+			#define xpMIN_SCALED_WIDTH	5		// 3?1 / 2?2 / 1?3
+			int MinWid = xpMIN_SCALED_WIDTH + IEC;
+			int MaxDigit = (psXP->flg.bMinWid && (psXP->flg.MinWid > MinWid)) ? psXP->flg.MinWid : MinWid;
+			MaxDigit -= (psXP->flg.bGroup ? 1 : 2) + IEC;	// lose 1 (?) or 2 (.?) positions, +1 for 'i'
+			int Flen = MaxDigit - Ilen;
+			Flen = (Flen < 0) ? 0 : (Flen > Fmax) ? Fmax : Flen;
+			// integer & retained fraction digits as one value, with at most one 64 bit division
+			u64_t Q;
+			if (IEC) {
+				int Shift = Scale * 10, Keep = (Shift < 40) ? Shift : 40;
+				u64_t F = (u64Val & ((1ULL << Shift) - 1)) >> (Shift - Keep);
+				Q = ((u64Val >> Shift) * u64Pow10[Flen]) + ((F * u64Pow10[Flen]) >> Keep);
+			} else {
+				Q = u64Val / u64Pow10[Fmax - Flen];
+			}
+			if (psXP->flg.bGroup == 0) {
+				if (IEC) {
+					*pTemp-- = CHR_i;
 					++Len;
 				}
-				// calculate & convert the required # of fractional digits
-				int Ilen = xDigitsInU32(I, 0);			// 1 (0) -> 3 (999)
-				int Flen = xDigitsInU32(F, 0);
-				// if field width has been specified, use that as base, adjusted for scaling character
-				#define xpMIN_SCALED_WIDTH	5		// 3?1 / 2?2 / 1?3
-				int MaxDigit = (psXP->flg.bMinWid && (psXP->flg.MinWid > xpMIN_SCALED_WIDTH)) ? psXP->flg.MinWid : xpMIN_SCALED_WIDTH;
-				MaxDigit -= psXP->flg.bGroup ? 1 : 2;	// lose 1 (?) or 2 (.?) positions
-				if ((Ilen + Flen) > MaxDigit) {			// if sum of I+F digits > available space
-					F /= u32pow(psXP->flg.uBase, Flen - (MaxDigit - Ilen));
-					Flen = MaxDigit - Ilen;				// adjust Flen to what remains
+				*pTemp-- = caScale[IEC][Scale - 1];
+				++Len;
+			}
+			while (Flen--) {
+				if (Q > UINT32_MAX) {					// very wide fields only
+					*pTemp-- = CHR_0 + Q % 10;
+					Q /= 10;
+				} else {
+					u32_t Q32 = Q;
+					*pTemp-- = CHR_0 + Q32 % 10;
+					Q = Q32 / 10;
 				}
-				while (Flen--) {
-					*pTemp-- = cPrintNibbleToChar(psXP, F % psXP->flg.uBase);	// digit
+				++Len;
+			}
+			if (psXP->flg.bGroup) {
+				if (IEC) {
+					*pTemp-- = CHR_i;
 					++Len;
-					F /= psXP->flg.uBase;
 				}
-				*pTemp-- = psXP->flg.bGroup ? ScaleChr : CHR_FULLSTOP;
+				*pTemp-- = caScale[IEC][Scale - 1];
+			} else {
+				*pTemp-- = CHR_FULLSTOP;
+			}
+			++Len;
+			if (Q == 0) {								// IEC 0.98Ki
+				*pTemp-- = CHR_0;
 				++Len;
-				u64Val = I;
 			}
+			u64Val = Q;
 		}
 		#endif
 		// convert to string starting at end of buffer from R/Least -> L/Most significant digits
@@ -433,32 +614,68 @@ static int	xPrintValueJustified(xp_t * psXP, u64_t u64Val, char * pBuffer, int B
 }
 
 /**
- * @brief	convert double value based on flags supplied and output via control structure
+ * @brief	convert whole and fractional parts, built R to L at the end of the buffer
  * @param	psXP pointer to control structure
- * @param	F64 double value to be converted
+ * @param	Whole integer portion
+ * @param	Frac fractional portion as an integer of Precis digits
+ * @param	Buffer xpfMAX_LEN_F64 characters, terminated
+ * @param	Len characters already built, exponent if any
+ * @param	u64XPC flags as saved by the caller, restored on return
+ * @return	number of characters, at Buffer + xpfMAX_LEN_F64 - 1 - Len
+ */
+static int xPrintFracBuild(xp_t * psXP, u64_t Whole, u64_t Frac, char * Buffer, int Len, u64_t u64XPC) {
+	xpc_t sXPC = { .u64XPC = u64XPC };
+	if (psXP->flg.bPrecis) {							// explicit MinWid specified ?
+		psXP->flg.MinWid = psXP->flg.Precis; 				// yes, stick to it.
+	} else if (Frac == 0) {								// process 0 value
+		psXP->flg.MinWid = psXP->flg.bRadix ? 1 : 0;
+	} else {											// process non 0 value
+		if (psXP->flg.bAltF && psXP->flg.uForm == form0G) {
+			psXP->flg.MinWid = psXP->flg.Precis;			// keep trailing 0's
+		} else {
+			u32_t u = u64Trailing0(Frac);
+			Frac /= u64pow(10, u);
+			psXP->flg.MinWid	= psXP->flg.Precis - u;		// remove trailing 0's
+		}
+	}
+	if (psXP->flg.MinWid > 0) {
+		psXP->flg.bPad0 = 1;							// MUST left pad with '0'
+		psXP->flg.bLeft = 0;							// leading 0's kept when left justified
+		psXP->flg.bAltF = 0;							// never scaled
+		psXP->flg.bGroup = 0;							// cannot group in fractional
+		psXP->flg.bSigned = 0;							// always unsigned value
+		psXP->flg.bNegVal = 0;							// and never negative
+		psXP->flg.bPlus = 0;							// no leading +/- before fractional part
+		Len += xPrintValueJustified(psXP, Frac, Buffer, xpfMAX_LEN_F64-1-Len);
+	}
+	// process the bRadix = '.'
+	if (psXP->flg.MinWid || psXP->flg.bRadix) {
+		Buffer[xpfMAX_LEN_F64 - 2 - Len] = CHR_FULLSTOP;
+		++Len;
+	}
+
+	// adjust MinWid to do padding (if required) based on string length after adding whole number
+	XPC_REST(psXP);
+	psXP->flg.MinWid = psXP->flg.MinWid > Len ? psXP->flg.MinWid - Len : 0;
+	Len += xPrintValueJustified(psXP, Whole, Buffer, xpfMAX_LEN_F64 - 1 - Len);
+	XPC_REST(psXP);
+	return Len;
+}
+
+/**
+ * @brief	convert a finite double value, built R to L at the end of the buffer
+ * @param	psXP pointer to control structure
+ * @param	F64 double value to be converted, not NAN or INF
+ * @param	Buffer xpfMAX_LEN_F64 characters, terminated
  * @note	Uses bCase bNegVal uForm Precis
- * @note	Changes bPrecis Precis
- * @note	Uses vPrintStringJustified()
- * @return	none
- *
- * References:
- * http://git.musl-libc.org/cgit/musl/blob/src/stdio/vfprintf.c?h=v1.1.6
- * https://en.cppreference.com/w/c/io/fprintf
- * https://pubs.opengroup.org/onlinepubs/007908799/xsh/fprintf.html
- * https://docs.microsoft.com/en-us/cpp/c-runtime-library/format-specification-syntax-printf-and-wprintf-functions?view=msvc-160
+ * @note	Changes bNegVal, all else restored
+ * @return	number of characters, at Buffer + xpfMAX_LEN_F64 - 1 - Len
  */
-static void vPrintF64(xp_t * psXP, double F64) {
+static int xPrintF64Build(xp_t * psXP, double F64, char * Buffer) {
 	const double round_nums[xpfMAXIMUM_DECIMALS+1] = {
 		0.5, 0.05, 0.005, 0.0005, 0.00005, 0.000005, 0.0000005, 0.00000005, 0.000000005,
 		0.0000000005, 0.00000000005, 0.000000000005, 0.0000000000005, 0.00000000000005,
 		0.000000000000005, 0.0000000000000005 };
-	if (isnan(F64)) {
-		vPrintStringJustified(psXP, psXP->flg.bCase ? "NAN" : "nan");
-		return;
-	} else if (isinf(F64)) {
-		vPrintStringJustified(psXP, psXP->flg.bCase ? "INF" : "inf");
-		return;
-	}
 	psXP->flg.bNegVal = F64 < 0.0 ? 1 : 0;				// set bNegVal if < 0.0
 	F64 *= psXP->flg.bNegVal ? -1.0 : 1.0;				// convert to positive number
 	XPC_SAVE(psXP);
@@ -484,7 +701,6 @@ static void vPrintF64(xp_t * psXP, double F64) {
 		F64 = X64.f64;									// change to exponent adjusted value
 	if (F64 < (DBL_MAX - round_nums[psXP->flg.Precis]))	// if addition of rounding value will NOT cause overflow.
 		F64 += round_nums[psXP->flg.Precis];			// round by adding .5LSB to the value
-	char Buffer[xpfMAX_LEN_F64];
 	Buffer[xpfMAX_LEN_F64 - 1] = 0;						// building R to L, ensure buffer NULL-term
 
 	int Len = 0;
@@ -503,44 +719,98 @@ static void vPrintF64(xp_t * psXP, double F64) {
 	X64.f64	= F64 - (u64_t) F64;						// isolate fraction as double
 	X64.f64	= X64.f64 * (double) u64pow(10, psXP->flg.Precis);	// fraction to integer
 	X64.u64	= (u64_t) X64.f64;							// extract integer portion
+	return xPrintFracBuild(psXP, (u64_t) F64, X64.u64, Buffer, Len, sXPC.u64XPC);
+}
 
-	if (psXP->flg.bPrecis) {							// explicit MinWid specified ?
-		psXP->flg.MinWid = psXP->flg.Precis; 				// yes, stick to it.
-	} else if (X64.u64 == 0) {							// process 0 value
-		psXP->flg.MinWid = psXP->flg.bRadix ? 1 : 0;
-	} else {											// process non 0 value
-		if (psXP->flg.bAltF && psXP->flg.uForm == form0G) {
-			psXP->flg.MinWid = psXP->flg.Precis;			// keep trailing 0's
+/**
+ * @brief	convert double value based on flags supplied and output via control structure
+ * @param	psXP pointer to control structure
+ * @param	F64 double value to be converted
+ * @note	Uses bCase bNegVal uForm Precis
+ * @note	Changes bPrecis Precis
+ * @note	Uses vPrintStringJustified()
+ * @return	none
+ *
+ * References:
+ * http://git.musl-libc.org/cgit/musl/blob/src/stdio/vfprintf.c?h=v1.1.6
+ * https://en.cppreference.com/w/c/io/fprintf
+ * https://pubs.opengroup.org/onlinepubs/007908799/xsh/fprintf.html
+ * https://docs.microsoft.com/en-us/cpp/c-runtime-library/format-specification-syntax-printf-and-wprintf-functions?view=msvc-160
+ */
+static void vPrintF64(xp_t * psXP, double F64) {
+	if (isnan(F64)) {
+		vPrintStringJustified(psXP, psXP->flg.bCase ? "NAN" : "nan");
+		return;
+	} else if (isinf(F64)) {
+		vPrintStringJustified(psXP, psXP->flg.bCase ? "INF" : "inf");
+		return;
+	}
+	char Buffer[xpfMAX_LEN_F64];
+	int Len = xPrintF64Build(psXP, F64, Buffer);
+	psXP->flg.bPrecis = 1;
+	psXP->flg.Precis = Len;
+	vPrintStringJustified(psXP, Buffer + (xpfMAX_LEN_F64 - 1 - Len));
+}
+
+#if	(xpfSUPPORT_FIXED == 1)
+/**
+ * @brief	convert a fixed point (scaled integer) value, integer arithmetic only
+ * @param	psXP pointer to control structure
+ * @param	X64 magnitude, from x64PrintGetValue() with bNegVal set if negative
+ * @param	Scale fractional decimal digits 0..19, or fractional bits 0..60 if bCase, else strOOR
+ * @note	Uses bCase bNegVal Precis, all else as vPrintF64() in 'f' form
+ * @note	Changes bPrecis Precis
+ * @note	Uses vPrintStringJustified()
+ */
+static void vPrintFixed(xp_t * psXP, x64_t X64, int Scale) {
+	if (Scale < 0 || Scale > (psXP->flg.bCase ? 60 : 19)) {	// outside u64Pow10[] or the shift range
+		psXP->flg.bPrecis = 0;
+		psXP->flg.Precis = 0;
+		vPrintStringJustified(psXP, strOOR);
+		return;
+	}
+	XPC_SAVE(psXP);
+	int Precis = psXP->flg.Precis;
+	u64_t Whole, Frac = 0;
+	if (psXP->flg.bCase) {								// Qm.n, n fractional bits
+		u64_t Mask = (1ULL << Scale) - 1, Rem = X64.u64 & Mask;
+		Whole = X64.u64 >> Scale;
+		for (int i = 0; i < Precis; ++i) {				// next digit from the top 4 bits, no division
+			Rem *= 10;
+			Frac = Frac * 10 + (Rem >> Scale);
+			Rem &= Mask;
+		}
+		if (Scale && Rem >= (1ULL << (Scale - 1)))		// round half up as vPrintF64()
+			++Frac;
+	} else {											// value * 10^-Scale
+		u64_t Rem;
+		if (X64.u64 <= UINT32_MAX && Scale <= 9) {		// hardware 32 bit divide
+			u32_t u32Val = X64.u64, u32Div = u64Pow10[Scale];
+			Whole = u32Val / u32Div;
+			Rem = u32Val % u32Div;
 		} else {
-			u32_t u = u64Trailing0(X64.u64);
-			X64.u64 /= u64pow(10, u);
-			psXP->flg.MinWid	= psXP->flg.Precis - u;		// remove trailing 0's
+			Whole = X64.u64 / u64Pow10[Scale];
+			Rem = X64.u64 - Whole * u64Pow10[Scale];
+		}
+		if (Precis >= Scale) {
+			Frac = Rem * u64Pow10[Precis - Scale];
+		} else {
+			u64_t Div = u64Pow10[Scale - Precis];
+			Frac = (Rem + Div / 2) / Div;				// round half up as vPrintF64()
 		}
 	}
-	if (psXP->flg.MinWid > 0) {
-		psXP->flg.bPad0 = 1;							// MUST left pad with '0'
-		psXP->flg.bGroup = 0;							// cannot group in fractional
-		psXP->flg.bSigned = 0;							// always unsigned value
-		psXP->flg.bNegVal = 0;							// and never negative
-		psXP->flg.bPlus = 0;							// no leading +/- before fractional part
-		Len += xPrintValueJustified(psXP, X64.u64, Buffer, xpfMAX_LEN_F64-1-Len);
-	}
-	// process the bRadix = '.'
-	if (psXP->flg.MinWid || psXP->flg.bRadix) {
-		Buffer[xpfMAX_LEN_F64 - 2 - Len] = CHR_FULLSTOP;
-		++Len;
+	if (Frac >= u64Pow10[Precis]) {						// rounded up into the whole part
+		Frac -= u64Pow10[Precis];
+		++Whole;
 	}
-
-	X64.u64	= F64;										// extract and convert the whole number portions
-	// adjust MinWid to do padding (if required) based on string length after adding whole number
-	XPC_REST(psXP);
-	psXP->flg.MinWid = psXP->flg.MinWid > Len ? psXP->flg.MinWid - Len : 0;
-	Len += xPrintValueJustified(psXP, X64.u64, Buffer, xpfMAX_LEN_F64 - 1 - Len);
-	XPC_REST(psXP);
+	char Buffer[xpfMAX_LEN_F64];
+	Buffer[xpfMAX_LEN_F64 - 1] = 0;						// building R to L, ensure buffer NULL-term
+	int Len = xPrintFracBuild(psXP, Whole, Frac, Buffer, 0, sXPC.u64XPC);
 	psXP->flg.bPrecis = 1;
 	psXP->flg.Precis = Len;
 	vPrintStringJustified(psXP, Buffer + (xpfMAX_LEN_F64 - 1 - Len));
 }
+#endif
 
 /**
  * @brief
@@ -600,162 +870,347 @@ static void vPrintPointer(xp_t * psXP, px_t pX) {
 
 // ############################## Proprietary extension: Arrays ####################################
 #if (xpfSUPPORT_ARRAYS > 0)
+/* Arrays (eg 512 ADC samples) are widened a chunk at a time by a loop specific to the element type,
+ * then converted element after element into one output window, separators included. Only elements
+ * that need the full string justification (left or centre padding, case folding, precision, NAN or
+ * INF) leave the window and take the single value path. */
+#define	xpfARRAY_CHUNK				16					// elements widened per pass
+#define	xpfARRAY_WINDOW				128					// output window, flushed when full
+
+enum { xpaU8, xpaU16, xpaU32, xpaU64, xpaI8, xpaI16, xpaI32, xpaI64, xpaF32, xpaF64 };
+
 /**
- * @brief	Generate array of values separated by ','
+ * @brief	widen array elements to x64_t, one tight loop per element type
+ * @param	pX64 destination, Count entries
+ * @param	pV first element
+ * @param	Count number of elements
+ * @param	Type xpa?? element type
+ */
+static void vPrintArrayFetch(x64_t * pX64, const void * pV, int Count, int Type) {
+	switch (Type) {
+	case xpaU8:	 for (int i = 0; i < Count; ++i) pX64[i].u64 = ((const u8_t *) pV)[i]; break;
+	case xpaU16: for (int i = 0; i < Count; ++i) pX64[i].u64 = ((const u16_t *) pV)[i]; break;
+	case xpaU32: for (int i = 0; i < Count; ++i) pX64[i].u64 = ((const u32_t *) pV)[i]; break;
+	case xpaI8:	 for (int i = 0; i < Count; ++i) pX64[i].i64 = ((const i8_t *) pV)[i]; break;
+	case xpaI16: for (int i = 0; i < Count; ++i) pX64[i].i64 = ((const i16_t *) pV)[i]; break;
+	case xpaI32: for (int i = 0; i < Count; ++i) pX64[i].i64 = ((const i32_t *) pV)[i]; break;
+	case xpaF32: for (int i = 0; i < Count; ++i) pX64[i].f64 = ((const f32_t *) pV)[i]; break;
+	default:	 memcpy(pX64, pV, Count * sizeof(x64_t)); break;	// u64, i64 & f64 as is
+	}
+}
+
+typedef struct {
+	int Type;											// xpa?? element type
+	int Step;											// element size in bytes
+	int bWindow;										// elements built into the window
+	char Cpad;
+	int Used;											// characters in the window
+	char Window[xpfARRAY_WINDOW];
+} xparray_t;
+
+/**
+ * @brief	add characters to the array output window, flushed first if they do not fit
  * @param	psXP
- * @note	Handles 8/16/32/64 bit values, un/signed/float
- * @note	Uses uSize bFloat bSigned 
- * @note	Changes CurLen indirectly through xPrintValueJustified() and vPrintStringJustified()
- * @note	Uses vPrintStringJustified()
-*/
-static void vPrintX64array(xp_t * psXP) {
-	vs_e eVS = (psXP->flg.uSize == S_hh) ? vs08B :
-				(psXP->flg.uSize == S_h) ? vs16B :
-				(psXP->flg.uSize == S_l) ? vs32B :
-				(psXP->flg.uSize == S_ll) ? vs64B : vs32B;
-	vf_e eVF = psXP->flg.bFloat ? vfFXX : psXP->flg.bSigned ? vfIXX : vfUXX;
-	cvi_e cvI = xFormSize2Index(eVF, eVS);
-	x32_t X32; X32.iX = va_arg(psXP->vaList, int);	// number of array elements
-	px_t pX; pX.pv = va_arg(psXP->vaList, void *);	// pointer to 1st element of array
+ * @param	psA array context
+ * @param	pcSrc characters, separators and row labels
+ * @param	Len number of characters
+ */
+static void vPrintArrayPut(xp_t * psXP, xparray_t * psA, const char * pcSrc, int Len) {
+	if (psA->Used + Len > xpfARRAY_WINDOW) {
+		xPrintChars(psXP, psA->Window, psA->Used);
+		psA->Used = 0;
+	}
+	if (Len > xpfARRAY_WINDOW) {						// wider than the window, straight out
+		xPrintChars(psXP, pcSrc, Len);
+		return;
+	}
+	memcpy(psA->Window + psA->Used, pcSrc, Len);
+	psA->Used += Len;
+}
+
+/**
+ * @brief	convert a run of adjacent elements, separated by cSep, into the output window
+ * @param	psXP
+ * @param	psA array context
+ * @param	pU first element
+ * @param	Count number of elements
+ * @param	cSep separator between elements
+ * @note	Changes bNegVal, restored with all other flags on return
+ */
+static void vPrintArrayRun(xp_t * psXP, xparray_t * psA, const u8_t * pU, int Count, char cSep) {
 	XPC_SAVE(psXP);
-	while (X32.iX) {
-		x64_t X64 = x64ValueFetch(pX, cvI);
-		if (eVF == vfIXX && X64.i64 < 0LL) {
-			psXP->flg.bNegVal = 1;
-			X64.i64 *= -1; 	// convert the value to unsigned
-		}
-		if (psXP->flg.bFloat) {
-			vPrintF64(psXP, X64.f64);
-		} else {
-			vPrintX64(psXP, X64.u64);
+	char Buffer[xpfMAX_LEN_F64];						// also fits xpfMAX_LEN_X64
+	x64_t aX64[xpfARRAY_CHUNK];
+	while (Count > 0) {
+		int Now = (Count < xpfARRAY_CHUNK) ? Count : xpfARRAY_CHUNK;
+		vPrintArrayFetch(aX64, pU, Now, psA->Type);
+		pU += Now * psA->Step;
+		Count -= Now;
+		for (int i = 0; i < Now; ++i) {
+			int Len = -1;								// -1 = single value path
+			if (psXP->flg.bFloat) {
+				if (psA->bWindow && !isnan(aX64[i].f64) && !isinf(aX64[i].f64))
+					Len = xPrintF64Build(psXP, aX64[i].f64, Buffer);
+			} else {
+				psXP->flg.bNegVal = (psA->Type >= xpaI8 && aX64[i].i64 < 0LL);
+				if (psXP->flg.bNegVal)
+					aX64[i].i64 *= -1;					// convert the value to unsigned
+				if (psA->bWindow)
+					Len = xPrintValueJustified(psXP, aX64[i].u64, Buffer, xpfMAX_LEN_F64 - 1);
+			}
+			if (Len < 0) {
+				xPrintChars(psXP, psA->Window, psA->Used);
+				psA->Used = 0;
+				if (psXP->flg.bFloat)
+					vPrintF64(psXP, aX64[i].f64);
+				else
+					vPrintX64(psXP, aX64[i].u64);
+				XPC_REST(psXP);
+			} else {
+				int Pad = (psXP->flg.MinWid > Len) ? psXP->flg.MinWid - Len : 0;
+				if (psA->Used + Pad + Len + 1 > xpfARRAY_WINDOW) {	// value, padding & separator
+					xPrintChars(psXP, psA->Window, psA->Used);
+					psA->Used = 0;
+				}
+				if (Pad > xpfARRAY_WINDOW - 1 - Len) {	// only very wide floats, straight out
+					vPrintPadding(psXP, psA->Cpad, Pad);
+					Pad = 0;
+				}
+				memset(psA->Window + psA->Used, psA->Cpad, Pad);
+				memcpy(psA->Window + psA->Used + Pad, Buffer + (xpfMAX_LEN_F64 - 1 - Len), Len);
+				psA->Used += Pad + Len;
+			}
+			if (Count || i < Now - 1)
+				psA->Window[psA->Used++] = cSep;
 		}
-		XPC_REST(psXP);
-		if (--X32.iX)
-			xPrintChar(psXP, CHR_COMMA);
-		pX = pxAddrNextWithIndex(pX, cvI);
 	}
+	XPC_REST(psXP);
 }
-#endif
 
-// ############################# Proprietary extension: hexdump ####################################
-#if	(xpfSUPPORT_HEXDUMP == 1)
 /**
- * @brief	write char value as 2 hex chars to the buffer, always NULL terminated
- * @param	psXP - pointer to control structure
- * @param	Value - unsigned byte to convert
- * @return	none
+ * @brief	count the elements that repeat the first, raw bytes compared a word at a time
+ * @param	pU first element
+ * @param	Count number of elements available
+ * @param	Step element size in bytes
+ * @return	run length, 1 if the next element differs
  */
-static void vPrintHexU8(xp_t * psXP, u8_t Value) {
-	xPrintChar(psXP, cPrintNibbleToChar(psXP, Value >> 4));
-	xPrintChar(psXP, cPrintNibbleToChar(psXP, Value & 0x0F));
+static int xPrintArraySame(const u8_t * pU, int Count, int Step) {
+	int Bytes = Count * Step, Now = Step;
+	if (Step < 8) {										// element repeated across a word
+		u32_t Pat = 0, Word;
+		memcpy(&Pat, pU, Step);
+		Pat = (Step == 1) ? Pat * 0x01010101UL : (Step == 2) ? Pat * 0x00010001UL : Pat;
+		while (Now + 4 <= Bytes) {
+			memcpy(&Word, pU + Now, 4);
+			if (Word != Pat)
+				break;
+			Now += 4;
+		}
+	} else {
+		u64_t Pat, Word;
+		memcpy(&Pat, pU, 8);
+		while (Now + 8 <= Bytes) {
+			memcpy(&Word, pU + Now, 8);
+			if (Word != Pat)
+				break;
+			Now += 8;
+		}
+	}
+	while (Now < Bytes && memcmp(pU + Now, pU, Step) == 0)	// tail, or the part word that differed
+		Now += Step;
+	return Now / Step;
 }
 
 /**
- * @brief	write u16_t value as 4 hex chars to the buffer, always NULL terminated
- * @param	psXP - pointer to control structure
- * @param	Value - unsigned short to convert
- * @return	none
+ * @brief	convert adjacent elements as with vPrintArrayRun(), runs of identical elements as "value*count"
+ * @param	psXP
+ * @param	psA array context
+ * @param	pU first element
+ * @param	Count number of elements
  */
-static void vPrintHexU16(xp_t * psXP, u16_t Value) {
-	vPrintHexU8(psXP, (Value >> 8) & 0x000000FF);
-	vPrintHexU8(psXP, Value & 0x000000FF);
+static void vPrintArrayPacked(xp_t * psXP, xparray_t * psA, const u8_t * pU, int Count) {
+	const char caSep[1] = { CHR_COMMA };
+	while (Count > 0) {
+		int Lit = 0, Same = 1;							// single elements up to the next run
+		while (Lit < Count && (Same = xPrintArraySame(pU + Lit * psA->Step, Count - Lit, psA->Step)) < 2)
+			++Lit;
+		if (Lit) {
+			vPrintArrayRun(psXP, psA, pU, Lit, CHR_COMMA);
+			pU += Lit * psA->Step;
+			Count -= Lit;
+			if (Count == 0)
+				break;
+			vPrintArrayPut(psXP, psA, caSep, 1);
+		}
+		char caRun[12];									// "*4294967295"
+		int Len = 0;
+		for (u32_t Val = Same; Val; Val /= 10)
+			caRun[sizeof(caRun) - 1 - Len++] = CHR_0 + Val % 10;
+		caRun[sizeof(caRun) - 1 - Len++] = CHR_ASTERISK;
+		vPrintArrayRun(psXP, psA, pU, 1, CHR_COMMA);
+		vPrintArrayPut(psXP, psA, caRun + sizeof(caRun) - Len, Len);
+		pU += Same * psA->Step;
+		Count -= Same;
+		if (Count)
+			vPrintArrayPut(psXP, psA, caSep, 1);
+	}
 }
 
 /**
- * @brief	write u32_t value as 8 hex chars to the buffer, always NULL terminated
- * @param	psXP - pointer to control structure
- * @param	Value - unsigned word to convert
- * @return	none
- */
-static void vPrintHexU32(xp_t * psXP, u32_t Value) {
-	vPrintHexU16(psXP, (Value >> 16) & 0x0000FFFF);
-	vPrintHexU16(psXP, Value & 0x0000FFFF);
+ * @brief	Generate array of values separated by ',', or a matrix with "&&"
+ * @param	psXP
+ * @note	Handles 8/16/32/64 bit values, un/signed/float
+ * @note	Uses uSize bFloat bSigned, with MinWid bLeft bAltF bGT bLT Precis selecting window or single value
+ * @note	Uses bMatrix, parameters xpmatrix_t pointer & element [0][0] pointer, rows fetched in order
+ * @note	Uses bRelVal, matrix rows prefixed with the right aligned row index and ": "
+ *			else array runs of 2 or more identical elements as "value*count"
+ * @note	Changes CurLen through xPrintChars(), or vPrintStringJustified() for elements leaving the window
+*/
+static void vPrintX64array(xp_t * psXP) {
+	xparray_t sA;
+	sA.Type = (psXP->flg.uSize == S_hh) ? xpaU8 :
+				(psXP->flg.uSize == S_h) ? xpaU16 :
+				(psXP->flg.uSize == S_ll) ? xpaU64 : xpaU32;
+	if (psXP->flg.bFloat)
+		sA.Type = (sA.Type == xpaU64) ? xpaF64 : xpaF32;
+	else if (psXP->flg.bSigned)
+		sA.Type += xpaI8 - xpaU8;
+	sA.Step = (sA.Type == xpaF32) ? 4 : (sA.Type == xpaF64) ? 8 : 1 << (sA.Type & 3);
+	// float elements are justified here unless padded left or centred, integers padded by the build
+	sA.bWindow = (psXP->flg.bGT || psXP->flg.bLT) ? 0 :
+				psXP->flg.bFloat ? (psXP->flg.bLeft == 0 && psXP->flg.bAltF == 0) :
+				(psXP->flg.bPrecis == 0 && psXP->flg.Precis == 0 && (psXP->flg.bLeft == 0 || psXP->flg.MinWid == 0));
+	sA.Cpad = psXP->flg.bPad0 ? CHR_0 : CHR_SPACE;
+	sA.Used = 0;
+	if (psXP->flg.bMatrix) {
+		const xpmatrix_t * psM = va_arg(psXP->vaList, const xpmatrix_t *);
+		const u8_t * pU = va_arg(psXP->vaList, const u8_t *);	// pointer to element [0][0]
+		IF_myASSERT(debugTRACK, halMemoryANY((void *) psM) && halMemoryANY(pU));
+		int Stride = psM->Stride ? psM->Stride : psM->Cols * sA.Step;
+		const char * pcRow = psM->pcRow ? psM->pcRow : strNL;
+		int RowLen = strlen(pcRow);
+		int Digits = xDigitsInU32(psM->Rows ? psM->Rows - 1 : 0, 0);
+		for (int Row = 0; Row < psM->Rows; ++Row, pU += Stride) {
+			if (psXP->flg.bRelVal) {					// "  7: " row index
+				char caIdx[8];
+				int Len = Digits + 2;
+				caIdx[Len - 1] = CHR_SPACE;
+				caIdx[Len - 2] = CHR_COLON;
+				for (int i = Len - 3, Val = Row; i >= 0; --i, Val /= 10)
+					caIdx[i] = (i == Len - 3 || Val) ? CHR_0 + Val % 10 : CHR_SPACE;
+				vPrintArrayPut(psXP, &sA, caIdx, Len);
+			}
+			vPrintArrayRun(psXP, &sA, pU, psM->Cols, psM->cCol ? psM->cCol : CHR_COMMA);
+			if (Row < psM->Rows - 1)
+				vPrintArrayPut(psXP, &sA, pcRow, RowLen);
+		}
+	} else {
+		int Count = va_arg(psXP->vaList, int);			// number of array elements
+		const u8_t * pU = va_arg(psXP->vaList, const u8_t *);	// pointer to 1st element of array
+		if (psXP->flg.bRelVal)
+			vPrintArrayPacked(psXP, &sA, pU, Count);
+		else
+			vPrintArrayRun(psXP, &sA, pU, Count, CHR_COMMA);
+	}
+	xPrintChars(psXP, sA.Window, sA.Used);
 }
+#endif
+
+// ############################# Proprietary extension: hexdump ####################################
+#if	(xpfSUPPORT_HEXDUMP == 1)
+/* Line kernel: every hexdump line (address, values, separators, ASCII column and NL) is built in
+ * one buffer and handed to the handler as a single block, instead of two handler calls per byte.
+ * Hex digits come from SWAR nibble spreading: the 8 nibbles of a u32 are spread into the 8 bytes of
+ * a u64, then all 8 become ASCII with one add, no branch and no table. The ESP32 has no SIMD unit,
+ * so one 64 bit word, 4 source bytes, is the widest useful step. */
+
+#define	xpfLEN_HEXLINE	(2 + (2 * xpfSIZE_POINTER) + 2 + (3 * xpfMAXWIDTH_HEXDUMP + 1) + xpfMAXWIDTH_HEXDUMP + sizeof(strNL))
 
 /**
- * @brief	write u64_t value as 16 hex chars to the buffer, always NULL terminated
- * @param	psXP - pointer to control structure
- * @param	Value - unsigned dword to convert
- * @return	none
+ * @brief	write the low order Digits nibbles of a value as hex characters, MS nibble first
+ * @param	pcBuf - destination, NOT terminated
+ * @param	Value - value to convert
+ * @param	Digits - number of characters, 1 to 8
+ * @param	bCase - 1 = 'A-F', 0 = 'a-f'
+ * @return	pointer to the next free position in the buffer
  */
-static void vPrintHexU64(xp_t * psXP, u64_t Value) {
-	vPrintHexU32(psXP, (Value >> 32) & 0xFFFFFFFFULL);
-	vPrintHexU32(psXP, Value & 0xFFFFFFFFULL);
+static char * pcPrintHexSWAR(char * pcBuf, u32_t Value, int Digits, int bCase) {
+	u64_t X = Value;
+	X = ((X & 0x00000000FFFF0000ULL) << 16) | (X & 0x000000000000FFFFULL);
+	X = ((X & 0x0000FF000000FF00ULL) << 8) | (X & 0x000000FF000000FFULL);
+	X = ((X & 0x00F000F000F000F0ULL) << 4) | (X & 0x000F000F000F000FULL);	// nibble n in byte n
+	u64_t Alpha = ((X + 0x0606060606060606ULL) >> 4) & 0x0101010101010101ULL;	// 1 where nibble > 9
+	X += 0x3030303030303030ULL + Alpha * (bCase ? (CHR_A - CHR_0 - 10) : (CHR_a - CHR_0 - 10));
+	while (Digits--)
+		*pcBuf++ = X >> (Digits * 8);
+	return pcBuf;
 }
 
 /**
- * @brief	write series of char values as hex chars to the buffer, always NULL terminated
+ * @brief	write series of values as hex chars to the buffer, NOT terminated
  * @param 	psXP
+ * @param	pcBuf destination, at least 3 x Num characters
  * @param 	Num number of bytes to print
  * @param 	pStr pointer to bytes to print
  * @note	Use the following modifier flags
  *			' select grouping separators ":- |" (byte/half/word/dword)
  *			# select reverse order (little/big endian)
- *			Uses uSize bAltF bGroup uForm
+ *			Uses uSize bAltF bGroup uForm bCase
+ * @return	number of characters written
  */
-static void vPrintHexValues(xp_t * psXP, int Num, char * pStr) {
+static int xPrintHexValuesLine(xp_t * psXP, char * pcBuf, int Num, const char * pStr) {
+	const u8_t * pU8 = (const u8_t *) pStr;
 	int s = S_bytes[psXP->flg.uSize];
+	IF_myASSERT(debugTRACK, s == 1 || s == 2 || s == 4 || s == 8);
+	int Step = psXP->flg.bAltF ? -s : s;
 	if (psXP->flg.bAltF)								// invert order ?
-		pStr += Num - s;								// working backwards so point to last
-	x64_t x64Val;
+		pU8 += Num - s;									// working backwards so point to last
+	char * pcNow = pcBuf;
 	int	Idx	= 0;
 	while (Idx < Num) {
-		switch (s >> 1) {
-		case 0:
-			x64Val.x8[0].u8 = *((u8_t *) pStr);
-			vPrintHexU8(psXP, x64Val.x8[0].u8);
-			break;
-		case 1:
-			x64Val.x16[0].u16 = *((u16_t *) pStr);
-			vPrintHexU16(psXP, x64Val.x16[0].u16);
-			break;
-		case 2:
-			x64Val.x32[0].u32 = *((u32_t *) pStr);
-			vPrintHexU32(psXP, x64Val.x32[0].u32);
-			break;
-		case 4:
-			x64Val.u64 = *((u64_t *) pStr);
-			vPrintHexU64(psXP, x64Val.u64);
-			break;
-		default:
-			assert(0);
-		}
-		// step to the next 8/16/32/64 bit value
-		if (psXP->flg.bAltF) {							// invert order ?
-			pStr -= s;									// update source pointer backwards
-		} else {
-			pStr += s;									// update source pointer forwards
+		if (s == 1 && psXP->flg.bGroup == 0 && (Num - Idx) >= 4) {	// 4 bytes, 8 digits, 1 word
+			u32_t Value = ((u32_t) pU8[0] << 24) | (pU8[Step] << 16) | (pU8[2 * Step] << 8) | pU8[3 * Step];
+			pcNow = pcPrintHexSWAR(pcNow, Value, 8, psXP->flg.bCase);
+			pU8 += 4 * Step;
+			Idx += 4;
+			continue;
 		}
+		x64_t x64Val = { .u64 = 0 };
+		memcpy(&x64Val, pU8, s);						// native order, alignment not required
+		if (s == 8)
+			pcNow = pcPrintHexSWAR(pcNow, x64Val.u64 >> 32, 8, psXP->flg.bCase);
+		pcNow = pcPrintHexSWAR(pcNow, (u32_t) x64Val.u64, (s == 8) ? 8 : s * 2, psXP->flg.bCase);
+		pU8 += Step;									// step to the next 8/16/32/64 bit value
 		Idx += s;
 		if (Idx >= Num)
 			break;
 		// now handle the grouping separator(s) if any
 		if (psXP->flg.bGroup) {							// separator required?
-			xPrintChar(psXP, (psXP->flg.uForm != form3X) ? CHR_COLON :
-							  (Idx % 8) == 0 ? CHR_SPACE :
-			  	  	  	  	  (Idx % 4) == 0 ? CHR_VERT_BAR :
-				  	  	  	  (Idx % 2) == 0 ? CHR_MINUS : CHR_COLON);
+			*pcNow++ = (psXP->flg.uForm != form3X) ? CHR_COLON :
+						(Idx % 8) == 0 ? CHR_SPACE :
+						(Idx % 4) == 0 ? CHR_VERT_BAR :
+						(Idx % 2) == 0 ? CHR_MINUS : CHR_COLON;
 		}
 	}
+	return pcNow - pcBuf;
 }
 
 /**
- * @brief		Dumps a block of memory in debug style format. depending on options output can be
- * @brief		formatted as 8/16/32 or 64 bit variables, optionally with no, absolute or relative address
+ * @brief	write series of values as hex chars, as one block
+ * @note	See xPrintHexValuesLine()
+ */
+static void vPrintHexValues(xp_t * psXP, int Num, char * pStr) {
+	char caBuf[3 * xpfMAXWIDTH_HEXDUMP];
+	IF_myASSERT(debugTRACK, Num <= xpfMAXWIDTH_HEXDUMP);
+	xPrintChars(psXP, caBuf, xPrintHexValuesLine(psXP, caBuf, Num, pStr));
+}
+
+/**
+ * @brief	determine the number of bytes per hexdump line, may disable the address and/or ASCII
  * @param[in]	psXP pointer to print control structure
- * @param[in]	pStr pointer to memory starting address
- * @param[in]	Len Length of memory buffer to display
- * @param[out]	none
- * @note		Use the following modifier flags
- * @note		'	Grouping of values using ' ' '-' or '|' as separators
- * @note		!	Use relative address format
- * @note		#	Use absolute address format
- * @note			Relative/absolute address prefixed using format '0x12345678:'
- * @note		+	Add the ASCII char equivalents to the right of the hex output
- * @return		none
+ * @return	bytes per line
  */
-static void vPrintHexDump(xp_t * psXP, int xLen, char * pStr) {
-	xpc_t sXPC = { .u64XPC = psXP->u64XPC };
+static int xPrintHexDumpWidth(xp_t * psXP) {
 	int iWidth;
 	if (psXP->flg.bMinWid && INRANGE(8, psXP->flg.MinWid, 64)) {
 		iWidth = psXP->flg.MinWid;
@@ -774,37 +1229,265 @@ static void vPrintHexDump(xp_t * psXP, int xLen, char * pStr) {
 		}
 		iWidth -= iWidth % 8;
 	}
-	if (iWidth > xpfMAXWIDTH_HEXDUMP)
-		iWidth = xpfMAXWIDTH_HEXDUMP;
+	return (iWidth > xpfMAXWIDTH_HEXDUMP) ? xpfMAXWIDTH_HEXDUMP : iWidth;
+}
+
+/**
+ * @brief	build one complete hexdump line
+ * @param[in]	psXP pointer to print control structure
+ * @param[in]	u64XPC control flags saved on entry, restored after the address as always
+ * @param[out]	pcLine buffer of at least xpfLEN_HEXLINE characters, NOT terminated
+ * @param[in]	pStr pointer to the data for THIS line
+ * @param[in]	Addr address to display, absolute or relative
+ * @param[in]	Width bytes on this line
+ * @param[in]	iWidth bytes per full line
+ * @param[in]	xLen total length of the dump
+ * @return	number of characters in the line
+ */
+static int xPrintHexDumpLine(xp_t * psXP, u64_t u64XPC, char * pcLine, const char * pStr,
+							uintptr_t Addr, int Width, int iWidth, int xLen) {
+	char * pcNow = pcLine;
+	if (psXP->flg.bLeft == 0) {							// display address (absolute/relative)
+		*pcNow++ = CHR_0;
+		*pcNow++ = psXP->flg.bCase ? CHR_X : CHR_x;
+		#if (xpfSIZE_POINTER == 8)
+		pcNow = pcPrintHexSWAR(pcNow, (u64_t) Addr >> 32, 8, psXP->flg.bCase);
+		#endif
+		pcNow = pcPrintHexSWAR(pcNow, (u32_t) Addr, (xpfSIZE_POINTER == 2) ? 4 : 8, psXP->flg.bCase);
+		*pcNow++ = CHR_COLON;
+		*pcNow++ = CHR_SPACE;
+		psXP->u64XPC = u64XPC;
+	}
+	// then the actual series of values in 8-32 bit groups
+	pcNow += xPrintHexValuesLine(psXP, pcNow, Width, pStr);
+	if (psXP->flg.bPlus) {								// ASCII equivalent requested?
+		int s = S_bytes[psXP->flg.uSize];
+		u32_t Count = (xLen <= iWidth) ? 1 :
+			((iWidth - Width) / s) * (s * 2 + (psXP->flg.bGroup ? 1 : 0)) + 1;
+		memset(pcNow, CHR_SPACE, Count);				// space padding for ASCII dump to line up
+		pcNow += Count;
+		for (Count = 0; Count < Width; ++Count) {		// values as ASCII characters
+			char cChr = pStr[Count];
+			// theoretically support up to 0xFF, but loses some characters idp.py and Serial
+			*pcNow++ = (cChr < 0x20 || cChr == 0x7F || cChr == 0xFF) ? CHR_FULLSTOP : cChr;
+		}
+	}
+	if (xLen > iWidth) {								// 1+ lines of output, do NL for this line
+		memcpy(pcNow, strNL, sizeof(strNL) - 1);
+		pcNow += sizeof(strNL) - 1;
+	}
+	return pcNow - pcLine;
+}
+
+/**
+ * @brief	build the line that replaces a run of duplicate hexdump lines, as "hexdump -C" does
+ * @param[out]	pcLine buffer of at least xpfLEN_HEXLINE characters, NOT terminated
+ * @param[in]	Dups number of lines suppressed
+ * @return	number of characters in the line
+ */
+static int xPrintHexDumpSkip(char * pcLine, u32_t Dups) {
+	char caBuf[xpfLEN_HEXLINE];
+	int Len = snprintfx(caBuf, sizeof(caBuf), "*  (%lu lines)" strNL, Dups);
+	memcpy(pcLine, caBuf, Len);
+	return Len;
+}
+
+/**
+ * @brief		Dumps a block of memory in debug style format. depending on options output can be
+ * @brief		formatted as 8/16/32 or 64 bit variables, optionally with no, absolute or relative address
+ * @param[in]	psXP pointer to print control structure
+ * @param[in]	pStr pointer to memory starting address
+ * @param[in]	Len Length of memory buffer to display
+ * @param[out]	none
+ * @note		Use the following modifier flags
+ * @note		'	Grouping of values using ' ' '-' or '|' as separators
+ * @note		!	Use relative address format
+ * @note		#	Use absolute address format
+ * @note			Relative/absolute address prefixed using format '0x12345678:'
+ * @note		+	Add the ASCII char equivalents to the right of the hex output
+ * @note		0	Collapse runs of lines identical to the previous one into "*  (N lines)", the last
+ * 				line is always shown so the final address remains visible
+ * @return		none
+ */
+static void vPrintHexDump(xp_t * psXP, int xLen, char * pStr) {
+	u64_t u64XPC = psXP->u64XPC;
+	int iWidth = xPrintHexDumpWidth(psXP);
+	char caLine[xpfLEN_HEXLINE];
+	u32_t Dups = 0;
 	for (int Now = 0; Now < xLen; Now += iWidth) {
-		if (psXP->flg.bLeft == 0) {						// display address (absolute/relative)
-			vPrintPointer(psXP, (px_t) (psXP->flg.bRelVal ? (void *) Now : (void *) (pStr + Now)));
-			vPrintString(psXP, (char *) ": ");
-			psXP->u64XPC = sXPC.u64XPC;
+		int Width = (xLen - Now) > iWidth ? iWidth : xLen - Now;
+		if (psXP->flg.bPad0 && Now && (Now + iWidth) < xLen && memcmp(pStr + Now, pStr + Now - iWidth, iWidth) == 0) {
+			++Dups;										// same as the previous, not the last
+			continue;
+		}
+		if (Dups) {
+			xPrintChars(psXP, caLine, xPrintHexDumpSkip(caLine, Dups));
+			Dups = 0;
 		}
-		// then the actual series of values in 8-32 bit groups
+		uintptr_t Addr = psXP->flg.bRelVal ? (uintptr_t) Now : (uintptr_t) (pStr + Now);
+		xPrintChars(psXP, caLine, xPrintHexDumpLine(psXP, u64XPC, caLine, pStr + Now, Addr, Width, iWidth, xLen));
+	}
+}
+
+/**
+ * @brief		Dumps only the lines where 2 buffers differ, changed bytes highlighted
+ * @param[in]	psXP pointer to print control structure
+ * @param[in]	xLen length of both buffers
+ * @param[in]	pOld pointer to the reference ("before") buffer
+ * @param[in]	pNew pointer to the buffer displayed ("after"), addresses are those of pNew
+ * @note		Same modifiers and line format as vPrintHexDump(), except '0'
+ * @note		Changed bytes are shown in colour if SGR is enabled (xReport), else a row of '^'
+ * 				markers follows each line. Identical lines are skipped with a single memcmp().
+ * @return		none
+ */
+static void vPrintHexDiff(xp_t * psXP, int xLen, char * pOld, char * pNew) {
+	u64_t u64XPC = psXP->u64XPC;
+	int iWidth = xPrintHexDumpWidth(psXP);
+	char caLine[xpfLEN_HEXLINE], caMark[3 * xpfMAXWIDTH_HEXDUMP];
+	u8_t caMask[xpfMAXWIDTH_HEXDUMP];
+	for (int Now = 0; Now < xLen; Now += iWidth) {
 		int Width = (xLen - Now) > iWidth ? iWidth : xLen - Now;
-		vPrintHexValues(psXP, Width, pStr + Now);
-		if (psXP->flg.bPlus) {							// ASCII equivalent requested?
-			int s = S_bytes[psXP->flg.uSize];
-			u32_t Count = (xLen <= iWidth) ? 1 :
-				((iWidth - Width) / s) * (s * 2 + (psXP->flg.bGroup ? 1 : 0)) + 1;
-			while (Count--)
-				xPrintChar(psXP, CHR_SPACE);			// handle space padding for ASCII dump to line up
-			for (Count = 0; Count < Width; ++Count) {	// values as ASCII characters
-				char cChr = *(pStr + Now + Count);
-				// theoretically support up to 0xFF, but loses some characters idp.py and Serial
-				xPrintChar(psXP, (cChr < 0x20 || cChr == 0x7F || cChr == 0xFF) ? CHR_FULLSTOP : cChr);
+		if (memcmp(pOld + Now, pNew + Now, Width) == 0)
+			continue;									// unchanged, not displayed
+		for (int i = 0; i < Width; ++i)
+			caMask[i] = (pOld[Now + i] != pNew[Now + i]) ? 0xFF : 0x00;
+		int Pre = psXP->flg.bLeft ? 0 : 2 + (2 * xpfSIZE_POINTER) + 2;	// "0x" address ": "
+		uintptr_t Addr = psXP->flg.bRelVal ? (uintptr_t) Now : (uintptr_t) (pNew + Now);
+		int Len = xPrintHexDumpLine(psXP, u64XPC, caLine, pNew + Now, Addr, Width, iWidth, xLen);
+		// mask rendered with the same flags, so 'f' lands exactly on the digits of changed bytes
+		int Hex = xPrintHexValuesLine(psXP, caMark, Width, (char *) caMask);
+		#if	(xpfSUPPORT_SGR == 1)
+		if (psXP->flg.uSGR == sgrANSI) {
+			char caOn[xpfMAX_LEN_SGR], caOff[xpfMAX_LEN_SGR];
+			pcTermAttrib(caOn, attrRESET, colourFG_RED);
+			pcTermAttrib(caOff, attrRESET, 0);
+			xPrintChars(psXP, caLine, Pre);
+			for (int i = 0; i < Hex; ) {
+				int bOn = (caMark[i] | 0x20) == CHR_f, Run = i;
+				while (Run < Hex && ((caMark[Run] | 0x20) == CHR_f) == bOn)
+					++Run;
+				if (bOn)
+					vPrintString(psXP, caOn);
+				xPrintChars(psXP, caLine + Pre + i, Run - i);
+				if (bOn)
+					vPrintString(psXP, caOff);
+				i = Run;
 			}
+			xPrintChars(psXP, caLine + Pre + Hex, Len - Pre - Hex);
+			continue;
 		}
-		if ((Now < xLen) && (xLen > iWidth))			// data left to be dumped & 1+ lines of output
-			vPrintString(psXP, strNL);					// do NL for this line.
+		#endif
+		xPrintChars(psXP, caLine, Len);
+		if (xLen <= iWidth)								// single line, has no NL of its own
+			vPrintString(psXP, strNL);
+		while (Hex && (caMark[Hex - 1] | 0x20) != CHR_f)
+			--Hex;										// no trailing spaces on the marker row
+		for (int i = 0; i < Hex; ++i)
+			caMark[i] = ((caMark[i] | 0x20) == CHR_f) ? CHR_CARET : CHR_SPACE;
+		vPrintPadding(psXP, CHR_SPACE, Pre);
+		xPrintChars(psXP, caMark, Hex);
+		if (xLen > iWidth)
+			vPrintString(psXP, strNL);
 	}
 }
 #endif
 
 // ############################# Proprietary extensions: date & time ###############################
 #if	(xpfSUPPORT_DATETIME == 1)
+/**
+ * @brief	Convert seconds into date & time components, without library or table
+ * @param	Seconds epoch or relative seconds
+ * @param	psTM pointer to date & time component structure to populate
+ * @param	bRelVal if set tm_mday is the number of elapsed days
+ * @note	Days to civil after H. Hinnant, the year shifted to start on 1 March so the leap day falls
+ *			last. Era, year of era and day of year are all divisions by constants, ie multiplies.
+ * @note	Populates tm_sec/min/hour/mday/mon/year/wday only, tm_year relative to YEAR_BASE_MIN
+ */
+static void vPrintGMTime(seconds_t Seconds, struct tm * psTM, int bRelVal) {
+	u32_t Days = Seconds / SECONDS_IN_DAY;
+	u32_t Secs = Seconds - Days * SECONDS_IN_DAY;
+	psTM->tm_hour = Secs / SECONDS_IN_HOUR;
+	Secs -= psTM->tm_hour * SECONDS_IN_HOUR;
+	psTM->tm_min = Secs / SECONDS_IN_MINUTE;
+	psTM->tm_sec = Secs - psTM->tm_min * SECONDS_IN_MINUTE;
+	psTM->tm_wday = (Days + 4) % 7;						// 1970-01-01 was a Thursday
+	u32_t Z = Days + 719468;							// days since 0000-03-01
+	u32_t Era = Z / 146097;								// 400 year eras
+	u32_t Doe = Z - Era * 146097;						// [0, 146096]
+	u32_t Yoe = (Doe - Doe / 1460 + Doe / 36524 - Doe / 146096) / 365;	// [0, 399]
+	u32_t Doy = Doe - (365 * Yoe + Yoe / 4 - Yoe / 100);	// [0, 365] from 1 March
+	u32_t Mp = (5 * Doy + 2) / 153;						// [0, 11] from March
+	psTM->tm_mday = bRelVal ? Days : Doy - (153 * Mp + 2) / 5 + 1;
+	psTM->tm_mon = Mp < 10 ? Mp + 2 : Mp - 10;
+	psTM->tm_year = Era * 400 + Yoe + (Mp >= 10) - YEAR_BASE_MIN;
+}
+
+/**
+ * @brief	Render absolute date and/or time into the fixed width "YYYY-MM-DDTHH:MM:SS.ffffff" template
+ * @param	psXP ponter to control structure
+ * @param	psTM pointer to date & time component structure
+ * @param	uSecs fraction of the second in uSecs
+ * @param	bDate render the date part, normal or '#' RFC-1123 form
+ * @param	bTime render the time part
+ * @note	Uses bAltF bGroup bRadix Precis, changes nothing
+ * @return	1 if rendered, 0 if the modifiers need the field by field path
+ */
+static int xPrintDateTimeFixed(xp_t * psXP, struct tm * psTM, u32_t uSecs, int bDate, int bTime) {
+	if (psXP->flg.bRelVal || psXP->flg.bNegVal || psXP->flg.bMinWid || psXP->flg.bLeft ||
+		psXP->flg.bGT || psXP->flg.bLT)
+		return 0;
+	char Buffer[xpfMAX_LEN_DATE + xpfMAX_LEN_TIME];
+	char * pcNow = Buffer;
+	int bGroup = psXP->flg.bGroup;
+	if (bDate) {
+		u32_t Year = psTM->tm_year + YEAR_BASE_MIN;
+		if (psXP->flg.bAltF) {							// "Sun, 10 Sep 2017-"
+			memcpy(pcNow, &caDayName[psTM->tm_wday * 3], 3);
+			pcNow[3] = CHR_COMMA;
+			pcNow[4] = CHR_SPACE;
+			memcpy(pcNow + 5, &caDigits2[psTM->tm_mday * 2], 2);
+			pcNow[7] = CHR_SPACE;
+			memcpy(pcNow + 8, &caMonName[psTM->tm_mon * 3], 3);
+			pcNow[11] = CHR_SPACE;
+			pcNow += 12;
+		}
+		memcpy(pcNow, &caDigits2[(Year / 100) * 2], 2);	// "2017-09-10T"
+		memcpy(pcNow + 2, &caDigits2[(Year % 100) * 2], 2);
+		pcNow[4] = Delim0[bGroup];
+		pcNow += 5;
+		if (psXP->flg.bAltF == 0) {
+			memcpy(pcNow, &caDigits2[(psTM->tm_mon + 1) * 2], 2);
+			pcNow[2] = Delim0[bGroup];
+			memcpy(pcNow + 3, &caDigits2[psTM->tm_mday * 2], 2);
+			pcNow[5] = Delim1[bGroup];
+			pcNow += 6;
+		}
+	}
+	if (bTime) {										// "12:34:56.789012"
+		memcpy(pcNow, &caDigits2[psTM->tm_hour * 2], 2);
+		pcNow[2] = Delim2[bGroup];
+		memcpy(pcNow + 3, &caDigits2[psTM->tm_min * 2], 2);
+		pcNow[5] = Delim3[bGroup];
+		memcpy(pcNow + 6, &caDigits2[psTM->tm_sec * 2], 2);
+		pcNow += 8;
+		int Precis = psXP->flg.Precis > xpfMAX_TIME_FRAC ? xpfMAX_TIME_FRAC : psXP->flg.Precis;
+		if (psXP->flg.bRadix || Precis)
+			*pcNow++ = CHR_FULLSTOP;
+		if (Precis) {									// all 6 digits, keep the leading Precis
+			u32_t Hi = uSecs / 10000;
+			u32_t Lo = uSecs - Hi * 10000;
+			memcpy(pcNow, &caDigits2[Hi * 2], 2);
+			memcpy(pcNow + 2, &caDigits2[(Lo / 100) * 2], 2);
+			memcpy(pcNow + 4, &caDigits2[(Lo % 100) * 2], 2);
+			pcNow += Precis;
+		}
+		if (bGroup)
+			*pcNow++ = CHR_s;
+	}
+	xPrintChars(psXP, Buffer, pcNow - Buffer);
+	return 1;
+}
+
 /**
  * @brief	Calculate # of local time seconds (uses TSZ info if available)
  * @note	Uses bPlus bAltF bRelVal
@@ -824,7 +1507,7 @@ static __attribute__((unused)) seconds_t xPrintCalcSeconds(xp_t * psXP, tsz_t *
 		Seconds = xTimeStampSeconds(psTSZ->usecs);
 	}
 	if (psTM)											// convert seconds into components
-		xTimeGMTime(Seconds, psTM, psXP->flg.bRelVal);
+		vPrintGMTime(Seconds, psTM, psXP->flg.bRelVal);
 	return Seconds;
 }
 
@@ -851,7 +1534,10 @@ static int	xPrintTimeCalcSize(xp_t * psXP, u32_t uVal) {		// REVIEW to make gene
  */
 static int	xPrintDate_Year(xp_t * psXP, struct tm * psTM, char * pBuffer) {
 	psXP->flg.MinWid = 0;
+	int bGroup = psXP->flg.bGroup;
+	psXP->flg.bGroup = 0;								// ' selects separators, never "2,017"
 	int Len = xPrintValueJustified(psXP, (u64_t) (psTM->tm_year + YEAR_BASE_MIN), pBuffer, 4);
+	psXP->flg.bGroup = bGroup;
 	if (psXP->flg.bAltF == 0)
 		pBuffer[Len++] = Delim0[psXP->flg.bGroup];
 	return Len;
@@ -895,11 +1581,14 @@ static void vPrintDate(xp_t * psXP, struct tm * psTM) {
 	int	Len = 0;
 	char Buffer[xpfMAX_LEN_DATE];
 	if (psXP->flg.bAltF) {
-		Len += xstrncpy(Buffer, xTimeGetDayName(psTM->tm_wday), 3);		// "Sun"
-		Len += xstrncpy(Buffer+Len, ", ", 2);							// "Sun, "
+		memcpy(Buffer, &caDayName[psTM->tm_wday * 3], 3);				// "Sun"
+		Buffer[3] = CHR_COMMA;
+		Buffer[4] = CHR_SPACE;											// "Sun, "
+		Len = 5;
 		Len += xPrintDate_Day(psXP, psTM, Buffer+Len);					// "Sun, 10 "
-		Len += xstrncpy(Buffer+Len, xTimeGetMonthName(psTM->tm_mon), 3);// "Sun, 10 Sep"
-		Len += xstrncpy(Buffer+Len, " ", 1);							// "Sun, 10 Sep "
+		memcpy(Buffer+Len, &caMonName[psTM->tm_mon * 3], 3);			// "Sun, 10 Sep"
+		Buffer[Len+3] = CHR_SPACE;										// "Sun, 10 Sep "
+		Len += 4;
 		psXP->flg.bAltF = 0;
 		Len += xPrintDate_Year(psXP, psTM, Buffer+Len);					// "Sun, 10 Sep 2017"
 	} else {
@@ -971,13 +1660,315 @@ static void vPrintTime(xp_t * psXP, struct tm * psTM, u32_t uSecs) {
 	vPrintStringJustified(psXP, Buffer);
 }
 
+/* _T_ prefixes every PXT message with "%!.3R" of the run time, and consecutive stamps mostly fall
+ * in the same second, or at least the same minute. So the last "[D]H:MM:SS." prefix rendered is
+ * cached per core:
+ *	same second						-> only the fraction digits are rendered
+ *	same minute, prefix has minutes	-> the fixed width SS digits are patched in place
+ *	anything else					-> the prefix is rendered once, via "%!.0R"
+ * Only the plain "%!.NR" form qualifies, any other modifier takes the normal path, as does a task
+ * that preempts another using the same core's entry. */
+typedef struct {
+	u64_t usBase;										// run time (uS) at the start of the cached second
+	u8_t bBusy;											// entry in use
+	u8_t Len;											// prefix length, up to and including the '.'
+	char caBuf[xpfMAX_LEN_TIME];
+} xprtc_t;
+
+static xprtc_t sRelCache[portNUM_PROCESSORS];
+
+/**
+ * @brief	render "%!.NR" from the per core prefix cache
+ * @param	psXP ponter to control structure
+ * @param	uSecs relative time in uSecs, already fetched
+ * @return	1 if rendered, 0 if this form or value does not qualify, caller takes the normal path
+ */
+static int xPrintRelTimeCached(xp_t * psXP, u64_t uSecs) {
+	if (psXP->flg.bRelVal == 0 || psXP->flg.bCase == 0 || psXP->flg.bNegVal || psXP->flg.bMinWid ||
+		psXP->flg.bGroup || psXP->flg.bAltF || psXP->flg.bLeft || psXP->flg.bPad0 || psXP->flg.bGT ||
+		psXP->flg.bLT || psXP->flg.Precis == 0 || psXP->flg.Precis > xpfMAX_TIME_FRAC)
+		return 0;
+	xprtc_t * psC = &sRelCache[xPortGetCoreID()];
+	if (__atomic_test_and_set(&psC->bBusy, __ATOMIC_ACQUIRE))
+		return 0;
+	u64_t Delta = uSecs - psC->usBase;
+	if (psC->Len == 0 || uSecs < psC->usBase || Delta >= MICROS_IN_SECOND) {
+		char * pcSS = NULL;
+		u32_t Step = 60, Sec = 60;
+		if (psC->Len >= 5 && uSecs > psC->usBase && Delta < (60 * MICROS_IN_SECOND)) {
+			Step = (u32_t) Delta / MICROS_IN_SECOND;
+			pcSS = &psC->caBuf[psC->Len - 3];			// "SS." if the prefix has minutes
+			if (pcSS[-1] == CHR_COLON)
+				Sec = (pcSS[0] - CHR_0) * 10 + pcSS[1] - CHR_0 + Step;
+		}
+		if (Sec < 60) {									// same minute, patch SS
+			pcSS[0] = CHR_0 + Sec / 10;
+			pcSS[1] = CHR_0 + Sec % 10;
+			psC->usBase += Step * MICROS_IN_SECOND;
+		} else {
+			u32_t Secs = uSecs / MICROS_IN_SECOND;		// same truncation as the normal path
+			psC->usBase = (u64_t) Secs * MICROS_IN_SECOND;
+			psC->Len = snprintfx(psC->caBuf, sizeof(psC->caBuf), "%!.0R", psC->usBase);
+		}
+		Delta = uSecs - psC->usBase;
+	}
+	char Buffer[xpfMAX_LEN_TIME + xpfMAX_TIME_FRAC];
+	int Len = psC->Len;
+	memcpy(Buffer, psC->caBuf, Len);
+	__atomic_clear(&psC->bBusy, __ATOMIC_RELEASE);
+	u32_t Frac = (u32_t) Delta;
+	if (psXP->flg.Precis < xpfMAX_TIME_FRAC)
+		Frac /= u32pow(10, xpfMAX_TIME_FRAC - psXP->flg.Precis);
+	for (int i = psXP->flg.Precis - 1; i >= 0; --i, Frac /= 10)
+		Buffer[Len + i] = CHR_0 + Frac % 10;
+	xPrintChars(psXP, Buffer, Len + psXP->flg.Precis);
+	return 1;
+}
+
+/* Local time zone rules. xPrintfxZoneSet() expands a POSIX TZ string into a table of the offsets in
+ * force from each transition, over xpfTZ_YEARS years around the year given, sorted by UTC start.
+ * Each entry carries its rendered "+02:00(SAST)" suffix, so a '+' stamp costs one binary search.
+ * The table is built in whichever of the 2 copies is not in use, then published by pointer, so
+ * readers are never stopped. Before the first transition entry 0 applies, after the last the last. */
+typedef struct {
+	seconds_t Start;									// UTC seconds from which Offset applies
+	i32_t Offset;										// seconds east of UTC, DST included
+	u8_t Len;											// suffix length
+	char caSfx[sizeof("+hh:mm()") + configTIME_MAX_LEN_TZNAME];
+} xptzt_t;
+
+typedef struct {
+	u8_t Count;
+	xptzt_t sT[1 + 2 * xpfTZ_YEARS];
+} xpzone_t;
+
+typedef struct {										// DST start or end rule
+	u8_t Type;											// 'M' month.week.day, 'J' 1-365 no Feb 29, 0 = 0-365
+	u8_t Mon, Week, WDay;
+	u16_t Day;
+	i32_t Time;											// local time of day the rule fires
+} xptzrule_t;
+
+static_assert(sizeof(((xptzt_t *) 0)->caSfx) <= configTIME_MAX_LEN_TZINFO, "zone suffix buffer");
+
+static xpzone_t sZone[2];
+static xpzone_t * psZoneNow;
+
+/**
+ * @brief	days since 1970-01-01 of a civil date, inverse of vPrintGMTime()
+ * @param	Year >= 1970, Mon 1-12, Day 1-31
+ */
+static u32_t xPrintCivilDays(u32_t Year, u32_t Mon, u32_t Day) {
+	Year -= (Mon <= 2);
+	u32_t Era = Year / 400;
+	u32_t Yoe = Year - Era * 400;						// [0, 399]
+	u32_t Doy = (153 * (Mon > 2 ? Mon - 3 : Mon + 9) + 2) / 5 + Day - 1;	// [0, 365] from 1 March
+	return Era * 146097 + Yoe * 365 + Yoe / 4 - Yoe / 100 + Doy - 719468;
+}
+
+/**
+ * @brief	parse up to 3 decimal digits
+ * @return	pointer past the digits, NULL if none
+ */
+static const char * pcPrintZoneNum(const char * pcTZ, int * piVal) {
+	if (!INRANGE(CHR_0, *pcTZ, CHR_9))
+		return NULL;
+	int Val = 0;
+	for (int i = 0; i < 3 && INRANGE(CHR_0, *pcTZ, CHR_9); ++i)
+		Val = Val * 10 + *pcTZ++ - CHR_0;
+	*piVal = Val;
+	return pcTZ;
+}
+
+/**
+ * @brief	parse a zone name, alphabetic or quoted as in "<+0530>"
+ * @return	pointer past the name, NULL if invalid or shorter than 3 characters
+ */
+static const char * pcPrintZoneName(const char * pcTZ, char * pcName) {
+	int Len = 0, Max = configTIME_MAX_LEN_TZNAME;
+	if (*pcTZ == '<') {
+		while (*++pcTZ && *pcTZ != '>')
+			if (Len < Max) pcName[Len++] = *pcTZ;
+		if (*pcTZ++ != '>')
+			return NULL;
+	} else {
+		for (; INRANGE(CHR_A, *pcTZ, CHR_Z) || INRANGE(CHR_a, *pcTZ, CHR_z); ++pcTZ)
+			if (Len < Max) pcName[Len++] = *pcTZ;
+	}
+	pcName[Len] = 0;
+	return (Len < 3) ? NULL : pcTZ;
+}
+
+/**
+ * @brief	parse [+|-]hh[:mm[:ss]] into seconds
+ * @return	pointer past the time, NULL if invalid
+ */
+static const char * pcPrintZoneTime(const char * pcTZ, i32_t * piSecs) {
+	int Sign = (*pcTZ == CHR_MINUS) ? -1 : 1;
+	if (*pcTZ == CHR_MINUS || *pcTZ == CHR_PLUS)
+		++pcTZ;
+	int Val;
+	i32_t Secs = 0;
+	for (i32_t Unit = SECONDS_IN_HOUR; ; Unit /= 60) {
+		if ((pcTZ = pcPrintZoneNum(pcTZ, &Val)) == NULL)
+			return NULL;
+		Secs += Val * Unit;
+		if (*pcTZ != CHR_COLON || Unit == 1)
+			break;
+		++pcTZ;
+	}
+	*piSecs = Sign * Secs;
+	return pcTZ;
+}
+
+/**
+ * @brief	parse ",Mm.w.d[/time]", ",Jn[/time]" or ",n[/time]"
+ * @return	pointer past the rule, NULL if invalid
+ */
+static const char * pcPrintZoneRule(const char * pcTZ, xptzrule_t * psR) {
+	int Val[3];
+	if (*pcTZ++ != CHR_COMMA)
+		return NULL;
+	psR->Type = (*pcTZ == CHR_M || *pcTZ == CHR_J) ? *pcTZ++ : 0;
+	if ((pcTZ = pcPrintZoneNum(pcTZ, &Val[0])) == NULL)
+		return NULL;
+	if (psR->Type == CHR_M) {
+		for (int i = 1; i < 3; ++i)
+			if (*pcTZ++ != CHR_FULLSTOP || (pcTZ = pcPrintZoneNum(pcTZ, &Val[i])) == NULL)
+				return NULL;
+		if (!INRANGE(1, Val[0], 12) || !INRANGE(1, Val[1], 5) || Val[2] > 6)
+			return NULL;
+		psR->Mon = Val[0];
+		psR->Week = Val[1];
+		psR->WDay = Val[2];
+	} else if (Val[0] > 365 || (psR->Type == CHR_J && Val[0] == 0)) {
+		return NULL;
+	}
+	psR->Day = Val[0];
+	psR->Time = 2 * SECONDS_IN_HOUR;					// POSIX default 02:00:00
+	if (*pcTZ == '/')
+		pcTZ = pcPrintZoneTime(pcTZ + 1, &psR->Time);
+	return pcTZ;
+}
+
+/**
+ * @brief	days since 1970-01-01 on which a rule fires in a year
+ */
+static u32_t xPrintZoneRuleDays(xptzrule_t * psR, u32_t Year) {
+	u32_t Days = xPrintCivilDays(Year, 1, 1);
+	if (psR->Type == 0)
+		return Days + psR->Day;
+	if (psR->Type == CHR_J)								// Feb 29 never counted
+		return Days + psR->Day - 1 + (psR->Day >= 60 && xPrintCivilDays(Year, 3, 1) - Days == 60);
+	Days = xPrintCivilDays(Year, psR->Mon, 1);
+	u32_t Next = (psR->Mon == 12) ? xPrintCivilDays(Year + 1, 1, 1) : xPrintCivilDays(Year, psR->Mon + 1, 1);
+	u32_t Day = (psR->WDay + 7 - (Days + 4) % 7) % 7 + (psR->Week - 1) * 7;	// Nth WDay, 0 relative
+	while (Days + Day >= Next)							// week 5 = last
+		Day -= 7;
+	return Days + Day;
+}
+
+/**
+ * @brief	populate a transition entry and render its suffix
+ */
+static void vPrintZoneEntry(xptzt_t * psT, i64_t Start, i32_t Offset, const char * pcName) {
+	psT->Start = (Start < 0) ? 0 : (Start > UINT32_MAX) ? UINT32_MAX : Start;
+	psT->Offset = Offset;
+	u32_t Abs = (Offset < 0) ? -Offset : Offset;
+	char * pcNow = psT->caSfx;
+	*pcNow++ = (Offset < 0) ? CHR_MINUS : CHR_PLUS;
+	memcpy(pcNow, &caDigits2[(Abs / SECONDS_IN_HOUR) * 2], 2);
+	pcNow[2] = CHR_COLON;
+	memcpy(pcNow + 3, &caDigits2[(Abs / SECONDS_IN_MINUTE % 60) * 2], 2);
+	pcNow += 5;
+	*pcNow++ = CHR_L_ROUND;
+	for (; *pcName; ++pcName)
+		*pcNow++ = *pcName;
+	*pcNow++ = CHR_R_ROUND;
+	psT->Len = pcNow - psT->caSfx;
+}
+
+int xPrintfxZoneSet(const char * pcTZ, int Year) {
+	if (pcTZ == NULL || *pcTZ == 0) {
+		__atomic_store_n(&psZoneNow, NULL, __ATOMIC_RELEASE);
+		return erSUCCESS;
+	}
+	if (!INRANGE(YEAR_BASE_MIN + xpfTZ_YEARS / 2, Year, 2105 - xpfTZ_YEARS / 2))
+		return erFAILURE;
+	char caStd[configTIME_MAX_LEN_TZNAME + 1], caDst[configTIME_MAX_LEN_TZNAME + 1];
+	i32_t Std, Dst;
+	xptzrule_t sR[2];
+	if ((pcTZ = pcPrintZoneName(pcTZ, caStd)) == NULL || (pcTZ = pcPrintZoneTime(pcTZ, &Std)) == NULL)
+		return erFAILURE;
+	Std = -Std;											// POSIX offsets are west of UTC
+	int bDST = (*pcTZ != 0);
+	if (bDST) {
+		if ((pcTZ = pcPrintZoneName(pcTZ, caDst)) == NULL)
+			return erFAILURE;
+		Dst = Std + SECONDS_IN_HOUR;
+		if (*pcTZ != 0 && *pcTZ != CHR_COMMA) {
+			if ((pcTZ = pcPrintZoneTime(pcTZ, &Dst)) == NULL)
+				return erFAILURE;
+			Dst = -Dst;
+		}
+		if (*pcTZ == 0)									// rules are implementation defined, US as glibc
+			pcTZ = ",M3.2.0,M11.1.0";
+		if ((pcTZ = pcPrintZoneRule(pcTZ, &sR[0])) == NULL || (pcTZ = pcPrintZoneRule(pcTZ, &sR[1])) == NULL)
+			return erFAILURE;
+	}
+	if (*pcTZ != 0 || Std <= -25 * SECONDS_IN_HOUR || Std >= 25 * SECONDS_IN_HOUR ||
+		(bDST && (Dst <= -25 * SECONDS_IN_HOUR || Dst >= 25 * SECONDS_IN_HOUR)))
+		return erFAILURE;
+
+	xpzone_t * psZ = &sZone[__atomic_load_n(&psZoneNow, __ATOMIC_ACQUIRE) == &sZone[0]];
+	xptzt_t * psT = &psZ->sT[1];
+	if (bDST) {
+		for (int Y = Year - xpfTZ_YEARS / 2; Y < Year - xpfTZ_YEARS / 2 + xpfTZ_YEARS; ++Y) {
+			i64_t On = (i64_t) xPrintZoneRuleDays(&sR[0], Y) * SECONDS_IN_DAY + sR[0].Time - Std;
+			i64_t Off = (i64_t) xPrintZoneRuleDays(&sR[1], Y) * SECONDS_IN_DAY + sR[1].Time - Dst;
+			int bSouth = (Off < On);					// DST spans the new year
+			vPrintZoneEntry(psT++, bSouth ? Off : On, bSouth ? Std : Dst, bSouth ? caStd : caDst);
+			vPrintZoneEntry(psT++, bSouth ? On : Off, bSouth ? Dst : Std, bSouth ? caDst : caStd);
+		}
+		// before the first transition the other offset applies
+		int bDstFirst = (psZ->sT[1].Offset == Dst);
+		vPrintZoneEntry(&psZ->sT[0], 0, bDstFirst ? Std : Dst, bDstFirst ? caStd : caDst);
+	} else {
+		vPrintZoneEntry(&psZ->sT[0], 0, Std, caStd);
+	}
+	psZ->Count = psT - psZ->sT;
+	__atomic_store_n(&psZoneNow, psZ, __ATOMIC_RELEASE);
+	return erSUCCESS;
+}
+
+/**
+ * @brief	find the transition in force at a UTC time
+ * @return	pointer to the entry, NULL if no zone rules set
+ */
+static const xptzt_t * psPrintZoneFind(seconds_t Secs) {
+	const xpzone_t * psZ = __atomic_load_n(&psZoneNow, __ATOMIC_ACQUIRE);
+	if (psZ == NULL)
+		return NULL;
+	const xptzt_t * psT = psZ->sT;
+	for (int N = psZ->Count; N > 1; N -= N / 2)		// last entry with Start <= Secs
+		psT = (psT[N / 2].Start <= Secs) ? psT + N / 2 : psT;
+	return psT;
+}
+
 /**
  * @brief	
+ * @param	psT transition in force from psPrintZoneFind(), NULL to use psTSZ->pTZ
  * @note	Uses vPrintStringJustified
  */
-static void vPrintZone(xp_t * psXP, tsz_t * psTSZ) {
+static void vPrintZone(xp_t * psXP, tsz_t * psTSZ, const xptzt_t * psT) {
 	int	Len = 0;
 	char Buffer[configTIME_MAX_LEN_TZINFO];
+	if (psT) {											// zone rules, suffix cached per transition
+		memcpy(Buffer, psT->caSfx, psT->Len);
+		Buffer[3] = Delim2[psXP->flg.bGroup];
+		xPrintChars(psXP, Buffer, psT->Len);
+		return;
+	}
 	if (psTSZ->pTZ == 0) {								// If no TZ info supplied
 		Buffer[Len++] = CHR_Z;
 
@@ -1043,51 +2034,566 @@ static void vPrintZone(xp_t * psXP, tsz_t * psTSZ) {
 	psXP->flg.MinWid = 0;								// enable full string
 	vPrintStringJustified(psXP, Buffer);
 }
+
+/* Batch timestamps for log export. The "YYYY-MM-DDT" date part is rendered once per day and the
+ * H:M:S fields are advanced from the previous stamp while it is less than a minute earlier, so a
+ * sorted 1Hz run does one 32 bit division per stamp, for the fraction, and no calendar work. */
+#define	xpfLEN_BATCH		(sizeof("2017-09-10T12:34:56.789012s") + sizeof(((xptzt_t *) 0)->caSfx))
+
+int xPrintfxTimeBatch(const xptlayout_t * psL, const unsigned long long * pu64, int Count,
+					char * pcBuf, size_t Size, int (* Sink)(void *, const char *, int), void * pvPara) {
+	int Pre = psL->pcPre ? strlen(psL->pcPre) : 0;
+	int Post = psL->pcPost ? strlen(psL->pcPost) : 0;
+	int Max = Pre + xpfLEN_BATCH + Post;
+	if (pcBuf == NULL || Count < 0 || Size <= Max)
+		return erFAILURE;
+	int Precis = psL->Options & xptFRAC;
+	if (Precis > xpfMAX_TIME_FRAC)
+		Precis = xpfMAX_TIME_FRAC;
+	int bGroup = (psL->Options & xptGROUP) ? 1 : 0;
+	char caDate[sizeof("2017-09-10T")];
+	u32_t DayStart = 0, Sod = SECONDS_IN_DAY, Secs = 0;	// nothing rendered yet
+	u64_t usSec = 0;
+	u8_t H = 0, M = 0, S = 0;
+	char * pcNow = pcBuf;
+	int Done;
+	for (Done = 0; Done < Count; ++Done) {
+		if ((pcBuf + Size - 1 - pcNow) < Max) {			// room for the longest stamp ?
+			if (Sink == NULL)
+				break;
+			if (Sink(pvPara, pcBuf, pcNow - pcBuf) < 0)
+				return erFAILURE;
+			pcNow = pcBuf;
+		}
+		u64_t uS = pu64[Done];
+		u32_t Step = (Done && uS >= usSec && (uS - usSec) < (60 * MICROS_IN_SECOND)) ?
+					(u32_t) (uS - usSec) / MICROS_IN_SECOND : 60;
+		if (Step < 60) {								// within a minute of the previous second
+			Secs += Step;
+			usSec += Step * MICROS_IN_SECOND;
+		} else {
+			Secs = uS / MICROS_IN_SECOND;
+			usSec = (u64_t) Secs * MICROS_IN_SECOND;
+			Step = 0;
+		}
+		u32_t Frac = uS - usSec;
+		const xptzt_t * psT = (psL->Options & xptLOCAL) ? psPrintZoneFind(Secs) : NULL;
+		u32_t Local = psT ? Secs + psT->Offset : Secs;
+		u32_t New = Local - DayStart;
+		if (Done == 0 || Local < DayStart || New >= SECONDS_IN_DAY) {	// new day, render the date part
+			struct tm sTM;
+			vPrintGMTime(Local, &sTM, 0);
+			u32_t Year = sTM.tm_year + YEAR_BASE_MIN;
+			memcpy(caDate, &caDigits2[(Year / 100) * 2], 2);
+			memcpy(caDate + 2, &caDigits2[(Year % 100) * 2], 2);
+			caDate[4] = caDate[7] = Delim0[bGroup];
+			memcpy(caDate + 5, &caDigits2[(sTM.tm_mon + 1) * 2], 2);
+			memcpy(caDate + 8, &caDigits2[sTM.tm_mday * 2], 2);
+			caDate[10] = Delim1[bGroup];
+			H = sTM.tm_hour;
+			M = sTM.tm_min;
+			S = sTM.tm_sec;
+			Sod = H * SECONDS_IN_HOUR + M * SECONDS_IN_MINUTE + S;
+			DayStart = Local - Sod;
+		} else if (New >= Sod && (New - Sod) < SECONDS_IN_MINUTE) {	// same day, step H:M:S
+			S += New - Sod;
+			if (S >= 60) {
+				S -= 60;
+				if (++M == 60) {
+					M = 0;
+					++H;
+				}
+			}
+			Sod = New;
+		} else {
+			Sod = New;
+			H = Sod / SECONDS_IN_HOUR;
+			M = (Sod - H * SECONDS_IN_HOUR) / SECONDS_IN_MINUTE;
+			S = Sod - H * SECONDS_IN_HOUR - M * SECONDS_IN_MINUTE;
+		}
+		if (Pre) {
+			memcpy(pcNow, psL->pcPre, Pre);
+			pcNow += Pre;
+		}
+		memcpy(pcNow, caDate, 11);
+		memcpy(pcNow + 11, &caDigits2[H * 2], 2);
+		pcNow[13] = Delim2[bGroup];
+		memcpy(pcNow + 14, &caDigits2[M * 2], 2);
+		pcNow[16] = Delim3[bGroup];
+		memcpy(pcNow + 17, &caDigits2[S * 2], 2);
+		pcNow += 19;
+		if (Precis) {									// all 6 digits, keep the leading Precis
+			*pcNow++ = CHR_FULLSTOP;
+			u32_t Hi = Frac / 10000;
+			u32_t Lo = Frac - Hi * 10000;
+			memcpy(pcNow, &caDigits2[Hi * 2], 2);
+			memcpy(pcNow + 2, &caDigits2[(Lo / 100) * 2], 2);
+			memcpy(pcNow + 4, &caDigits2[(Lo % 100) * 2], 2);
+			pcNow += Precis;
+		}
+		if (bGroup)
+			*pcNow++ = CHR_s;
+		if (psT) {
+			memcpy(pcNow, psT->caSfx, psT->Len);
+			pcNow[3] = Delim2[bGroup];
+			pcNow += psT->Len;
+		} else if (psL->Options & (xptZULU | xptLOCAL)) {
+			*pcNow++ = CHR_Z;
+		}
+		if (Post) {
+			memcpy(pcNow, psL->pcPost, Post);
+			pcNow += Post;
+		}
+	}
+	if (Sink && pcNow > pcBuf && Sink(pvPara, pcBuf, pcNow - pcBuf) < 0)
+		return erFAILURE;
+	*pcNow = 0;
+	return Done;
+}
+#endif
+
+// ################################ ANSI SGR, state & escape cache #################################
+#if	(xpfSUPPORT_SGR == 1)
+/* %C sends cursor and attribute escapes built by pcTermLocate() and pcTermAttrib(). Attribute escapes
+ * repeat a lot, xReportBitMap() colours label after label, and sending the pair already in effect
+ * changes nothing. So:
+ *	the last attribute pair sent is kept in an xpsgr_t, the same pair is not sent again
+ *	attribute escapes already built are kept in a small direct mapped cache, shared by both cores
+ * Only the caller knows what else writes to a stream, so state across calls is opt-in: the caller
+ * owns one xpsgr_t per stream, passes it to xPrintFXState() (xReport() does so from report_t), and
+ * forgets it when something else may have changed the attributes. Otherwise the state lives for one
+ * call. Output that sends its own escapes (the %&Y diff) forgets the state. */
+
+typedef struct {
+	u16_t Attrib;
+	u8_t bValid;
+	u8_t Len;											// 0 if pcTermAttrib() produced nothing
+	char caSeq[xpfMAX_LEN_SGR];
+} xpsgrc_t;
+
+static xpsgrc_t saSGRCache[xpfSGR_CACHE];
+static u8_t bSGRBusy;
+
+/**
+ * @brief	send an attribute escape, unless already in effect on the stream
+ * @param	psXP
+ * @param	psSGR attribute state, of the stream or of this xPrintFX() call
+ * @param	Attrib attribute pair, a1 (MSB) & a2 (LSB)
+ */
+static void vPrintSGRAttrib(xp_t * psXP, xpsgr_t * psSGR, u16_t Attrib) {
+	if (psSGR->bValid && psSGR->Attrib == Attrib)		// already in effect
+		return;
+	int bTables = (__atomic_test_and_set(&bSGRBusy, __ATOMIC_ACQUIRE) == 0);
+	char Buffer[xpfMAX_LEN_SGR];
+	int Len;
+	if (bTables) {
+		xpsgrc_t * psC = &saSGRCache[(Attrib ^ (Attrib >> 5)) & (xpfSGR_CACHE - 1)];
+		if (psC->bValid == 0 || psC->Attrib != Attrib) {
+			psC->Len = pcTermAttrib(psC->caSeq, Attrib >> 8, Attrib & 0xFF) - psC->caSeq;
+			psC->Attrib = Attrib;
+			psC->bValid = 1;
+		}
+		Len = psC->Len;
+		memcpy(Buffer, psC->caSeq, Len);
+	} else {
+		Len = pcTermAttrib(Buffer, Attrib >> 8, Attrib & 0xFF) - Buffer;
+	}
+	psSGR->Attrib = Attrib;
+	psSGR->bValid = 1;
+	if (bTables)
+		__atomic_clear(&bSGRBusy, __ATOMIC_RELEASE);
+	if (Len)
+		xPrintChars(psXP, Buffer, Len);
+}
+#endif
+
+// ############################# Proprietary extension: IP addresses ###############################
+#if	(xpfSUPPORT_IP_ADDR == 1)
+/**
+ * @brief	Format IPv4 address into buffer, octets copied from the "000" to "255" table
+ * @param	psXP ponter to control structure
+ * @param	Addr IPv4 address, byte 0 output last unless bAltF
+ * @param	pcBuf buffer, at least xpfMAX_LEN_IP
+ * @note	Uses bAltF bLeft bPad0
+ * @return	length of string built, not terminated
+ */
+static int xPrintIPv4(xp_t * psXP, u32_t Addr, char * pcBuf) {
+	u8_t * pChr = (u8_t *) &Addr;
+	char * pcNow = pcBuf;
+	for (int Idx = 0; Idx < sizeof(u32_t); ++Idx) {
+		const char * pcOct = &caOctet[pChr[psXP->flg.bAltF ? Idx : 3 - Idx] * 4];
+		if (psXP->flg.bLeft) {							// no padding
+			memcpy(pcNow, pcOct + 3 - pcOct[3], pcOct[3]);
+			pcNow += pcOct[3];
+		} else {										// 3 wide, '0' or ' ' padded
+			memcpy(pcNow, pcOct, 3);
+			if (psXP->flg.bPad0 == 0)
+				memcpy(pcNow, caPadSpace, 3 - pcOct[3]);
+			pcNow += 3;
+		}
+		*pcNow++ = CHR_FULLSTOP;
+	}
+	return pcNow - pcBuf - 1;							// drop the trailing '.'
+}
+
+/**
+ * @brief	Format IPv6 address into buffer as RFC 5952 text
+ * @param	pAddr 16 bytes, network order
+ * @param	pcBuf buffer, at least xpfMAX_LEN_IPV6
+ * @note	lower case hex, no leading 0's, longest run of 2+ zero groups (first if tied) as "::",
+ *			IPv4 mapped addresses as "::ffff:192.168.0.1"
+ * @return	length of string built, not terminated
+ */
+static int xPrintIPv6(const u8_t * pAddr, char * pcBuf) {
+	u16_t Group[8];
+	int Best = -1, BestLen = 1, Run = 0;
+	for (int Idx = 0; Idx < 8; ++Idx) {
+		Group[Idx] = (pAddr[2 * Idx] << 8) | pAddr[2 * Idx + 1];
+		Run = Group[Idx] ? 0 : Run + 1;
+		if (Run > BestLen) {
+			BestLen = Run;
+			Best = Idx + 1 - Run;
+		}
+	}
+	int bMapped = (Best == 0 && BestLen == 5 && Group[5] == 0xFFFF);
+	char * pcNow = pcBuf;
+	int bSep = 0;
+	for (int Idx = 0; Idx < 8; ++Idx) {
+		if (Idx == Best) {								// zero run
+			*pcNow++ = CHR_COLON;
+			*pcNow++ = CHR_COLON;
+			Idx += BestLen - 1;
+			bSep = 0;
+			continue;
+		}
+		if (bSep)
+			*pcNow++ = CHR_COLON;
+		bSep = 1;
+		if (bMapped && Idx == 6) {						// dotted quad, unpadded
+			for (int i = 12; i < 16; ++i) {
+				const char * pcOct = &caOctet[pAddr[i] * 4];
+				memcpy(pcNow, pcOct + 3 - pcOct[3], pcOct[3]);
+				pcNow += pcOct[3];
+				*pcNow++ = CHR_FULLSTOP;
+			}
+			--pcNow;
+			break;
+		}
+		u32_t Val = Group[Idx];
+		for (int Shift = (Val > 0xFFF) ? 12 : (Val > 0xFF) ? 8 : (Val > 0xF) ? 4 : 0; Shift >= 0; Shift -= 4)
+			*pcNow++ = hexchars[(Val >> Shift) & 0xF] | 0x20;	// '0'-'9' unchanged, 'A'-'F' to lower
+	}
+	return pcNow - pcBuf;
+}
+#endif
+
+// ############################ Pointer classification, region map ################################
+
+/* %s, %U, %M and %Y each range check their pointer, and %s does it on EVERY conversion. The hal
+ * helpers each walk their own compare chain per call. One table, sorted by start address, answered
+ * by a branchless binary search over a handful of entries, serves all of them. Entries are [Lo, Hi)
+ * and must not overlap, the static_asserts below keep the ESP32 map in order if the SOC headers
+ * move. Targets without a map here keep the hal calls. With xpfTRUST_POINTERS only NULL is caught. */
+
+enum { xpmEXE = 1 << 0, xpmRAM = 1 << 1, xpmROM = 1 << 2, xpmEXT = 1 << 3 };
+
+typedef struct { uintptr_t Lo, Hi; u8_t Attr; } xpmem_t;
+
+#if (xpfTRUST_POINTERS == 1)
+	#define	xpfMEM_ANY(p)			((p) != NULL)
+	#define	xpfMEM_RAM(p)			((p) != NULL)
+
+#elif defined(CONFIG_IDF_TARGET_ESP32)
+	static_assert(SOC_DROM_HIGH <= SOC_EXTRAM_DATA_LOW && SOC_EXTRAM_DATA_HIGH <= SOC_RTC_DRAM_LOW, "ESP32 map order");
+	static_assert(SOC_RTC_DRAM_HIGH <= SOC_DRAM_LOW && SOC_DRAM_HIGH <= SOC_IROM_MASK_LOW, "ESP32 map order");
+	static_assert(SOC_IROM_MASK_HIGH <= SOC_IRAM_LOW && SOC_IRAM_HIGH <= SOC_RTC_IRAM_LOW, "ESP32 map order");
+	static_assert(SOC_RTC_IRAM_HIGH <= SOC_IROM_LOW && SOC_IROM_HIGH <= SOC_RTC_DATA_LOW, "ESP32 map order");
+	static const xpmem_t saMemMap[] = {
+		{ SOC_DROM_LOW,			SOC_DROM_HIGH,			xpmROM },			// flash rodata
+		{ SOC_EXTRAM_DATA_LOW,	SOC_EXTRAM_DATA_HIGH,	xpmRAM | xpmEXT },	// PSRAM
+		{ SOC_RTC_DRAM_LOW,		SOC_RTC_DRAM_HIGH,		xpmRAM },			// RTC fast, data bus
+		{ SOC_DRAM_LOW,			SOC_DRAM_HIGH,			xpmRAM },			// internal SRAM
+		{ SOC_IROM_MASK_LOW,	SOC_IROM_MASK_HIGH,		xpmROM | xpmEXE },	// mask ROM
+		{ SOC_IRAM_LOW,			SOC_IRAM_HIGH,			xpmEXE },			// IRAM
+		{ SOC_RTC_IRAM_LOW,		SOC_RTC_IRAM_HIGH,		xpmEXE },			// RTC fast, instruction bus
+		{ SOC_IROM_LOW,			SOC_IROM_HIGH,			xpmROM | xpmEXE },	// flash text
+		{ SOC_RTC_DATA_LOW,		SOC_RTC_DATA_HIGH,		xpmRAM },			// RTC slow
+	};
+
+#elif !defined(ESP_PLATFORM)							// host stand-in, typical Linux user space
+	static const xpmem_t saMemMap[] = {
+	#if (xpfSIZE_POINTER == 8)
+		{ 0x000000010000ULL,	0x000000400000ULL,		xpmROM | xpmEXE },	// non-PIE text
+		{ 0x000000400000ULL,	0x000040000000ULL,		xpmRAM },			// non-PIE data + brk heap
+		{ 0x550000000000ULL,	0x570000000000ULL,		xpmRAM | xpmEXE },	// PIE image + brk heap
+		{ 0x7F0000000000ULL,	0x800000000000ULL,		xpmRAM },			// mmap, libraries, stacks
+	#else
+		{ 0x00010000UL,			0xFFFF0000UL,			xpmRAM | xpmEXE },
+	#endif
+	};
+
+#else
+	#define	xpfMEM_ANY(p)			halMemoryANY(p)
+	#define	xpfMEM_RAM(p)			halMemoryRAM(p)
+#endif
+
+#ifndef xpfMEM_ANY
+	/**
+	 * @brief	classify a pointer against the region map
+	 * @param	pV pointer to classify
+	 * @return	region attributes, 0 if outside every region (including NULL)
+	 */
+	static int xPrintMemClass(const void * pV) {
+		uintptr_t A = (uintptr_t) pV;
+		const xpmem_t * psM = saMemMap;
+		for (int N = sizeof(saMemMap) / sizeof(saMemMap[0]); N > 1; N -= N / 2)		// last entry with Lo <= A
+			psM = (psM[N / 2].Lo <= A) ? psM + N / 2 : psM;
+		return (psM->Lo <= A && A < psM->Hi) ? psM->Attr : 0;
+	}
+	#define	xpfMEM_ANY(p)			(xPrintMemClass(p) != 0)
+	#define	xpfMEM_RAM(p)			(xPrintMemClass(p) & xpmRAM)
 #endif
 
 // ################################# Proprietary extension: URLs ###################################
 #if	(xpfSUPPORT_URL == 1)
 /**
- * @brief	generate URL 
+ * @brief	generate URL percent encoded output, runs of unreserved characters emitted as blocks
  * @param	psXP
- * @param	pString
+ * @param	pStr string, or any bytes if Precis specified
+ * @note	Uses bPrecis Precis, if specified the byte count to encode, NUL included, else to NUL
  * @note	Uses vPrintStringJustified
  */
-static void vPrintURL(xp_t * psXP, char * pStr) {
-	if (halMemoryANY(pStr)) {
-		char cIn;
-		while ((cIn = *pStr++) != 0) {
-//			if (INRANGE(CHR_A, cIn, CHR_Z) || INRANGE(CHR_a, cIn, CHR_z) || INRANGE(CHR_0, cIn, CHR_9) || cIn == CHR_MINUS || cIn == CHR_FULLSTOP || cIn == CHR_UNDERSCORE || cIn == CHR_TILDE) {
-			if (isalnum(cIn) || strchr_i("-._~", cIn)) {
-				xPrintChar(psXP, cIn);
-			} else {
-				xPrintChar(psXP, CHR_PERCENT);
-				xPrintChar(psXP, cPrintNibbleToChar(psXP, cIn >> 4));
-				xPrintChar(psXP, cPrintNibbleToChar(psXP, cIn & 0x0F));
-			}
+static void vPrintURL(xp_t * psXP, const char * pStr) {
+	if (xpfMEM_ANY(pStr) == 0) {
+		vPrintStringJustified(psXP, pStr);				// "null" or "pOOR"
+		return;
+	}
+	const u8_t * pNow = (const u8_t *) pStr;
+	const u8_t * pEnd = psXP->flg.bPrecis ? pNow + psXP->flg.Precis : NULL;	// NULL = to NUL
+	char Buffer[3 * 16];
+	while (1) {
+		const u8_t * pRun = pNow;
+		while (pNow != pEnd && xpURL_SAFE(*pNow))		// NUL is not safe, ends the run
+			++pNow;
+		if (pNow > pRun)
+			xPrintChars(psXP, (const char *) pRun, pNow - pRun);
+		if (pNow == pEnd || (pEnd == NULL && *pNow == 0))
+			break;
+		int Len = 0;
+		do {											// run of escapes, emitted in blocks
+			memcpy(Buffer + Len, &caURLEscape[*pNow++ * 3], 3);
+			Len += 3;
+		} while (Len < (int) sizeof(Buffer) && pNow != pEnd && xpURL_SAFE(*pNow) == 0 && (pEnd || *pNow));
+		xPrintChars(psXP, Buffer, Len);
+	}
+}
+#endif
+
+// ############################## Proprietary extension: JSON strings ##############################
+#if	(xpfSUPPORT_JSON == 1)
+/**
+ * @brief	escape one character that is not passed as is
+ * @param	pcBuf - destination, space for 12 characters
+ * @param	ppU - pointer to source pointer, advanced past the bytes consumed
+ * @param	pEnd - end of source, NULL if only the terminator ends it
+ * @note	non-ASCII decoded from UTF-8 to "\uXXXX", surrogate pairs above U+FFFF, invalid sequences as U+FFFD
+ * @return	number of characters written
+ */
+static int xPrintJSONEscape(char * pcBuf, const u8_t ** ppU, const u8_t * pEnd) {
+	const u8_t * pU = *ppU;
+	u32_t CP = *pU++;
+	u8_t Class = caJSON[CP];
+	if (Class > 1 && Class != 'u') {
+		*ppU = pU;
+		pcBuf[0] = '\\';
+		pcBuf[1] = Class;
+		return 2;
+	}
+	if (Class == 1) {									// UTF-8 lead byte, 1 to 3 continuation bytes
+		int N = (CP >= 0xF5) ? 0 : (CP >= 0xF0) ? 3 : (CP >= 0xE0) ? 2 : (CP >= 0xC2) ? 1 : 0;
+		u32_t Val = CP & (0x3F >> N);
+		u8_t Lo = (CP == 0xE0) ? 0xA0 : (CP == 0xF0) ? 0x90 : 0x80;	// no overlong forms
+		u8_t Hi = (CP == 0xED) ? 0x9F : (CP == 0xF4) ? 0x8F : 0xBF;	// no surrogates, <= U+10FFFF
+		int Idx;
+		for (Idx = 0; Idx < N; ++Idx) {
+			if ((pEnd && pU + Idx >= pEnd) || pU[Idx] < Lo || pU[Idx] > Hi)
+				break;									// also stops on the terminator
+			Val = (Val << 6) | (pU[Idx] & 0x3F);
+			Lo = 0x80;
+			Hi = 0xBF;
 		}
-	} else {
-		vPrintStringJustified(psXP, pStr);						// "null" or "pOOR"
+		CP = (N && Idx == N) ? Val : 0xFFFD;			// one U+FFFD per maximal invalid subpart
+		pU += Idx;
+	}
+	*ppU = pU;
+	int Len = 0;
+	if (CP > 0xFFFF) {									// high surrogate first
+		u32_t Hi = 0xD800 + ((CP - 0x10000) >> 10);
+		CP = 0xDC00 + (CP & 0x3FF);
+		pcBuf[Len++] = '\\';
+		pcBuf[Len++] = 'u';
+		for (int Shift = 12; Shift >= 0; Shift -= 4)
+			pcBuf[Len++] = hexchars[(Hi >> Shift) & 0xF] | 0x20;
+	}
+	pcBuf[Len++] = '\\';
+	pcBuf[Len++] = 'u';
+	for (int Shift = 12; Shift >= 0; Shift -= 4)
+		pcBuf[Len++] = hexchars[(CP >> Shift) & 0xF] | 0x20;
+	return Len;
+}
+
+/**
+ * @brief	escape a string, runs of clean characters emitted as blocks, escapes in blocks
+ * @param	psXP
+ * @param	pU - source string
+ * @param	pEnd - end of source, NULL if only the terminator ends it
+ * @param	Limit - classes below this are passed as is, 2 = non-ASCII as is, 1 = non-ASCII escaped
+ * @param	bCount - 1 to only count the output length, 0 to output
+ * @return	number of characters (to be) output
+ */
+static size_t xPrintJSONRun(xp_t * psXP, const u8_t * pU, const u8_t * pEnd, int Limit, int bCount) {
+	size_t Total = 0;
+	char Buffer[48];
+	while (1) {
+		const u8_t * pRun = pU;
+		while (pU != pEnd && caJSON[*pU] < Limit)		// terminator is class 'u', ends the run
+			++pU;
+		if (pU > pRun) {
+			if (bCount == 0)
+				xPrintChars(psXP, (const char *) pRun, pU - pRun);
+			Total += pU - pRun;
+		}
+		if (pU == pEnd || *pU == 0)
+			break;
+		int Len = 0;
+		do {
+			Len += xPrintJSONEscape(Buffer + Len, &pU, pEnd);
+		} while (Len <= (int) sizeof(Buffer) - 12 && pU != pEnd && *pU && caJSON[*pU] >= Limit);
+		if (bCount == 0)
+			xPrintChars(psXP, Buffer, Len);
+		Total += Len;
+	}
+	return Total;
+}
+
+/**
+ * @brief	generate JSON/C escaped string output, '"' '\' and control characters escaped
+ * @param	psXP
+ * @param	pStr string to be escaped
+ * @note	Uses bAltF, non-ASCII as "\uXXXX" for pure ASCII output
+ * @note	Uses bPrecis Precis, maximum number of source bytes as for %s
+ * @note	Uses MinWid bLeft, escaped length counted with the class table, no scratch buffer
+ */
+static void vPrintJSON(xp_t * psXP, const char * pStr) {
+	if (xpfMEM_ANY(pStr) == 0) {
+		vPrintStringJustified(psXP, pStr ? strOOR : strNULL);
+		return;
 	}
+	const u8_t * pU = (const u8_t *) pStr;
+	const u8_t * pEnd = psXP->flg.bPrecis ? pU + psXP->flg.Precis : NULL;
+	int Limit = psXP->flg.bAltF ? 1 : 2;
+	size_t Pad = 0;
+	if (psXP->flg.MinWid) {
+		size_t Len = xPrintJSONRun(psXP, pU, pEnd, Limit, 1);
+		Pad = (psXP->flg.MinWid > Len) ? psXP->flg.MinWid - Len : 0;
+	}
+	if (Pad && psXP->flg.bLeft == 0)
+		vPrintPadding(psXP, CHR_SPACE, Pad);
+	xPrintJSONRun(psXP, pU, pEnd, Limit, 0);
+	if (Pad && psXP->flg.bLeft)
+		vPrintPadding(psXP, CHR_SPACE, Pad);
 }
 #endif
 
 // ################################# Proprietary extension: UUID ###################################
 #if	(xpfSUPPORT_UUID == 1)
 /**
- * @brief	generate UUID 
+ * @brief	generate UUID, 16 bytes as 8-4-4-4-12 hex digits, in one pass via the byte to hex table
  * @param	psXP
- * @param	pString
+ * @param	pU pointer to 16 bytes, in the order printed
+ * @note	Uses bCase, 'V' upper or 'v' lower case
  * @note	Uses vPrintStringJustified
  */
-static void vPrintUUID(xp_t * psXP, char * pStr) {
-	if (halMemoryANY(pStr)) {
-		char cIn;
-		while ((cIn = *pStr++) != 0) {
+static void vPrintUUID(xp_t * psXP, const u8_t * pU) {
+	if (xpfMEM_ANY(pU) == 0) {
+		vPrintStringJustified(psXP, pU ? strOOR : strNULL);
+		return;
+	}
+	const char * pcHex = caHex2[psXP->flg.bCase];
+	char Buffer[xpfMAX_LEN_UUID];
+	char * pcNow = Buffer;
+	for (int Idx = 0; Idx < 16; ++Idx) {
+		memcpy(pcNow, &pcHex[pU[Idx] * 2], 2);
+		pcNow += 2;
+		if (Idx == 3 || Idx == 5 || Idx == 7 || Idx == 9)
+			*pcNow++ = CHR_MINUS;
+	}
+	*pcNow = 0;
+	vPrintStringJustified(psXP, Buffer);
+}
+#endif
+
+// ################################ Proprietary extension: Base64 ##################################
+#if	(xpfSUPPORT_BASE64 == 1)
+/**
+ * @brief	generate Base64 output straight into the output window, 3 bytes to 4 characters per step
+ * @param	psXP
+ * @param	Len number of bytes to encode
+ * @param	pU pointer to the bytes
+ * @note	Uses bAltF, RFC 4648 URL safe alphabet without '=' padding
+ * @note	Uses MinWid bLeft, output length is known up front so justification costs no buffer
+ * @note	Uses MaxLen CurLen, output stops on the last whole quad that fits
+ */
+static void vPrintBase64(xp_t * psXP, int Len, const u8_t * pU) {
+	if (xpfMEM_ANY(pU) == 0) {
+		vPrintStringJustified(psXP, pU ? strOOR : strNULL);
+		return;
+	}
+	if (Len < 0)										// nothing to encode
+		Len = 0;
+	const char * pcAlpha = caBase64[psXP->flg.bAltF];
+	size_t Size = psXP->flg.bAltF ? (Len * 4 + 2) / 3 : (Len + 2) / 3 * 4;
+	size_t Pad = (psXP->flg.MinWid > Size) ? psXP->flg.MinWid - Size : 0;
+	if (Pad && psXP->flg.bLeft == 0)
+		vPrintPadding(psXP, CHR_SPACE, Pad);
+	if (psXP->MaxLen) {									// limit input to whole quads that fit
+		size_t Avail = (psXP->MaxLen > psXP->CurLen) ? psXP->MaxLen - psXP->CurLen : 0;
+		if (Avail && psXP->hdlr == xPrintToString)		// last position taken by the terminator
+			--Avail;
+		if (Size > Avail) {
+			Len = Avail / 4 * 3;
+			Pad = 0;
 		}
-	} else {
-		vPrintStringJustified(psXP, pStr);						// "null" or "pOOR"
 	}
+	char Buffer[64];									// 48 input bytes per block
+	while (Len > 0) {
+		int Now = 0;
+		while (Len >= 3 && Now < (int) sizeof(Buffer)) {
+			u32_t X = (pU[0] << 16) | (pU[1] << 8) | pU[2];
+			Buffer[Now+0] = pcAlpha[X >> 18];
+			Buffer[Now+1] = pcAlpha[(X >> 12) & 0x3F];
+			Buffer[Now+2] = pcAlpha[(X >> 6) & 0x3F];
+			Buffer[Now+3] = pcAlpha[X & 0x3F];
+			pU += 3;
+			Len -= 3;
+			Now += 4;
+		}
+		if (Len > 0 && Len < 3 && Now < (int) sizeof(Buffer)) {	// tail, 1 or 2 bytes
+			u32_t X = (pU[0] << 16) | ((Len == 2) ? pU[1] << 8 : 0);
+			Buffer[Now++] = pcAlpha[X >> 18];
+			Buffer[Now++] = pcAlpha[(X >> 12) & 0x3F];
+			if (Len == 2)
+				Buffer[Now++] = pcAlpha[(X >> 6) & 0x3F];
+			else if (psXP->flg.bAltF == 0)
+				Buffer[Now++] = '=';
+			if (psXP->flg.bAltF == 0)
+				Buffer[Now++] = '=';
+			Len = 0;
+		}
+		xPrintChars(psXP, Buffer, Now);
+	}
+	if (Pad && psXP->flg.bLeft)
+		vPrintPadding(psXP, CHR_SPACE, Pad);
 }
 #endif
 
@@ -1096,15 +2602,21 @@ static void vPrintUUID(xp_t * psXP, char * pStr) {
  * @param[in]	Hdlr pointer to output handler
  * @param[in]	pvPara optional parameter for some handlers
  * @param[in]	Size bitmapped flags (top XPC_BITS_XFER bits) and size (bottom xpfMINWID_BITS bits)
+ * @param[in]	psSGR %C attribute state of the destination stream, NULL to keep it for this call only
  * @param[in]	pcFmt pointer to the formatting string
  * @param[in]	vaList variable argument list structure
  * @return	number of characters output
  */
 
-int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * pcFmt, va_list vaList) {
+int	xPrintFXState(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, xpsgr_t * psSGR, const char * pcFmt, va_list vaList) {
 	if (pcFmt == NULL)
 		return 0;
 	xp_t sXP = { 0 };
+	#if	(xpfSUPPORT_SGR == 1)
+	xpsgr_t sSGRCall = { 0 };							// %C attribute state, this call only
+	if (psSGR == NULL)
+		psSGR = &sSGRCall;
+	#endif
 	sXP.hdlr = Hdlr;
 	sXP.pvPara = pvPara;
 	sXP.vaList = vaList;
@@ -1131,8 +2643,14 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 			while ((cFmt = strchr_i("!#&'*+-0><", *pcFmt)) != erFAILURE) {
 				switch (cFmt) {
 				case 0:	sXP.flg.bRelVal = 1; break;		// !	HEXDUMP/DTZ abs->rel address/time, MAC use ':' separator
-				case 1:	sXP.flg.bAltF = 1; break;		// #	DTZ=GMT format, HEXDUMP/IP swop endian, STRING centre
-				case 2: sXP.flg.bArray = 1; break;		// &	Array address ( and length) provided
+				case 1:									// #	DTZ=GMT format, HEXDUMP/IP swop endian, STRING centre
+					sXP.flg.bIEC = sXP.flg.bAltF;		// ##	"diu" IEC instead of SI scaling
+					sXP.flg.bAltF = 1;
+					break;
+				case 2:									// &	Array address ( and length) provided
+					sXP.flg.bMatrix = sXP.flg.bArray;	// &&	Matrix layout & address provided
+					sXP.flg.bArray = 1;
+					break;
 				case 3: sXP.flg.bGroup = 1; break;		// '	"diu" add 3 digit grouping, DTZ, MAC, DUMP select separator set
 				case 4: {								// *	indicate argument will supply field width
 					X32.iX	= va_arg(sXP.vaList, int);
@@ -1249,8 +2767,7 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 				if (sXP.flg.uSGR == sgrANSI) {
 					if (sSGR.rowcol && pcTermLocate(Buffer, sSGR.r, sSGR.c) != Buffer)
 						vPrintString(&sXP, Buffer);		// cursor location, 1 relative row & column
-					if (pcTermAttrib(Buffer, sSGR.a1, sSGR.a2) != Buffer)
-						vPrintString(&sXP, Buffer);		// attribute[s]
+					vPrintSGRAttrib(&sXP, psSGR, sSGR.attrib);	// attribute[s], unless in effect
 				}
 			}	break;
 			#endif
@@ -1258,26 +2775,22 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 			#if	(xpfSUPPORT_IP_ADDR == 1)				// IP address
 			case CHR_I: {
 				IF_myASSERT(debugTRACK, !sXP.flg.bPrecis && !sXP.flg.Precis && !sXP.flg.bPlus);
+				char Buffer[xpfMAX_LEN_IPV6];
+				if (sXP.flg.uSize == S_ll) {			// IPv6, pointer to 16 bytes
+					pX.pu8 = va_arg(sXP.vaList, u8_t *);
+					IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pu8));
+					if (xpfMEM_ANY(pX.pu8)) {
+						Buffer[xPrintIPv6(pX.pu8, Buffer)] = 0;
+						vPrintStringJustified(&sXP, Buffer);
+					} else {
+						vPrintStringJustified(&sXP, pX.pu8 ? strOOR : strNULL);
+					}
+					break;
+				}
 				sXP.flg.MinWid = sXP.flg.bLeft ? 0 : 3;
 				X32.u32 = va_arg(sXP.vaList, u32_t);
-				u8_t temp;
-				u8_t * pChr = (u8_t *) &X32;
-				if (sXP.flg.bAltF) {					// '#' specified to invert order ?
-					temp = *pChr;		*pChr = *(pChr+3);		*(pChr+3) = temp;
-					temp = *(pChr+1);	*(pChr+1) = *(pChr+2);	*(pChr+2) = temp;
-					sXP.flg.bAltF = 0;					// clear so not to confuse xPrintValueJustified()
-				}
-				char Buffer[xpfMAX_LEN_IP];
-				Buffer[xpfMAX_LEN_IP - 1] = 0;			// building R to L, ensure buffer NULL-term
-				int	Idx, Len;
-				for (Idx = 0, Len = 0; Idx < sizeof(u32_t); ++Idx) {	// then convert the IP address, LSB first
-					X64.u64 = (u8_t) pChr[Idx];
-					Len += xPrintValueJustified(&sXP, X64.u64, Buffer + xpfMAX_LEN_IP - 5 - Len, 4);
-					if (Idx < 3)
-						Buffer[xpfMAX_LEN_IP - 1 - ++Len] = CHR_FULLSTOP;
-				}
-				// then send the formatted output to the correct stream
-				vPrintStringJustified(&sXP, Buffer + (xpfMAX_LEN_IP - 1 - Len));
+				Buffer[xPrintIPv4(&sXP, X32.u32, Buffer)] = 0;
+				vPrintStringJustified(&sXP, Buffer);
 			}	break;
 			#endif
 
@@ -1304,24 +2817,31 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 			case CHR_Z: {			// Local TZ DATE+TIME+ZONE
 				IF_myASSERT(debugTRACK, sXP.flg.bRelVal == 0);
 				psTSZ = va_arg(sXP.vaList, tsz_t *);	// retrieve TSX pointer parameter
-				IF_myASSERT(debugTRACK, halMemoryRAM(psTSZ));
+				IF_myASSERT(debugTRACK, xpfMEM_RAM(psTSZ));
 				X32.u32 = xTimeStampSeconds(psTSZ->usecs);				// convert to u32_t epoch value
-				if (sXP.flg.bPlus && psTSZ->pTZ)		// If full local time required, add TZ and DST offsets
+				const xptzt_t * psT = (sXP.flg.bPlus && sXP.flg.bAltF == 0) ? psPrintZoneFind(X32.u32) : NULL;
+				if (psT)								// zone rules set, offset in force at this time
+					X32.u32 += psT->Offset;
+				else if (sXP.flg.bPlus && psTSZ->pTZ)	// If full local time required, add TZ and DST offsets
 					X32.u32 += psTSZ->pTZ->timezone + (int) psTSZ->pTZ->daylight;
-				xTimeGMTime(X32.u32, &sTM, sXP.flg.bRelVal);				// Convert to component values
+				vPrintGMTime(X32.u32, &sTM, sXP.flg.bRelVal);				// Convert to component values
 				sXP.flg.bPad0 = 1;						// Need 0 on date & time, want to restore same
 				XPC_SAVE(&sXP);
 				sXP.flg.bPlus = 0;						// only for DTZone, need to restore status later..
-				if (cFmt == CHR_D || cFmt == CHR_Z) {
-					vPrintDate(&sXP, &sTM);				// bPad0=1, bPlus=0
-					XPC_REST(&sXP);						// bAltF changed
-				}
-				if (cFmt == CHR_T || cFmt == CHR_Z) {
-					vPrintTime(&sXP, &sTM, (u32_t)(psTSZ->usecs % MICROS_IN_SECOND));
+				X32.u32 = (u32_t)(psTSZ->usecs % MICROS_IN_SECOND);
+				if (xPrintDateTimeFixed(&sXP, &sTM, X32.u32, cFmt != CHR_T, cFmt != CHR_D) == 0) {
+					if (cFmt == CHR_D || cFmt == CHR_Z) {
+						vPrintDate(&sXP, &sTM);			// bPad0=1, bPlus=0
+						XPC_REST(&sXP);					// bAltF changed
+						sXP.flg.bPlus = 0;				// TZ only, not a '+' on the hours
+					}
+					if (cFmt == CHR_T || cFmt == CHR_Z) {
+						vPrintTime(&sXP, &sTM, X32.u32);
+					}
 				}
 				if (cFmt == CHR_Z) {
 					XPC_REST(&sXP);
-					vPrintZone(&sXP, psTSZ);
+					vPrintZone(&sXP, psTSZ, psT);
 				}
 			}
 			break;
@@ -1331,10 +2851,14 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 				sXP.flg.bSigned = sXP.flg.bRelVal ? 1 : 0;		// Relative values signed
 				sXP.flg.uSize = sXP.flg.bCase ? S_ll : S_l;		// 'R' = 64bit, 'r' = 32bit
 				X64 = x64PrintGetValue(&sXP);
+				if (xPrintRelTimeCached(&sXP, X64.u64))
+					break;
 				X32.u32 = (u32_t) sXP.flg.bCase ? (X64.u64 / MICROS_IN_SECOND) : X64.u64;
-				xTimeGMTime(X32.u32, &sTM, sXP.flg.bRelVal);
+				vPrintGMTime(X32.u32, &sTM, sXP.flg.bRelVal);
 				if (sXP.flg.bRelVal == 0)				// absolute (not relative) value
 					sXP.flg.bPad0 = 1;				// must pad
+				if (xPrintDateTimeFixed(&sXP, &sTM, sXP.flg.bCase ? X64.u64 % MICROS_IN_SECOND : 0, 1, 1))
+					break;
 				if (sXP.flg.bRelVal == 0 || sTM.tm_mday) {
 					XPC_SAVE(&sXP);
 					vPrintDate(&sXP, &sTM);
@@ -1348,10 +2872,38 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 			break;
 			#endif
 
+			#if	(xpfSUPPORT_UUID == 1)					// para = pointer to 16 bytes
+			case CHR_v: {
+				pX.pu8 = va_arg(sXP.vaList, u8_t *);
+				IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pu8));
+				vPrintUUID(&sXP, pX.pu8);
+				break;
+			}
+			#endif
+
+			#if	(xpfSUPPORT_BASE64 == 1)				// para = length (if not specified) and pointer to bytes
+			case CHR_W: {
+				X32.iX = sXP.flg.bPrecis ? sXP.flg.Precis : va_arg(sXP.vaList, int);
+				pX.pu8 = va_arg(sXP.vaList, u8_t *);
+				IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pu8));
+				vPrintBase64(&sXP, X32.iX, pX.pu8);
+				break;
+			}
+			#endif
+
+			#if	(xpfSUPPORT_JSON == 1)					// para = pointer to string to be escaped
+			case CHR_J: {
+				pX.pc8 = va_arg(sXP.vaList, char *);
+				IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pc8));
+				vPrintJSON(&sXP, pX.pc8);
+				break;
+			}
+			#endif
+
 			#if	(xpfSUPPORT_URL == 1)					// para = pointer to string to be encoded
 			case CHR_U: {
 				pX.pc8 = va_arg(sXP.vaList, char *);
-				IF_myASSERT(debugTRACK, halMemoryANY(pX.pc8));
+				IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pc8));
 				vPrintURL(&sXP, pX.pc8);
 				break;
 			}
@@ -1368,7 +2920,7 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 				IF_myASSERT(debugTRACK, sXP.flg.bMinWid == 0 && sXP.flg.bPrecis == 0);
 				sXP.flg.uSize = S_hh;					// force interpretation as sequence of U8 values
 				pX.pc8 = va_arg(sXP.vaList, char *);
-				IF_myASSERT(debugTRACK, halMemoryANY(pX.pc8));
+				IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pc8));
 				vPrintHexValues(&sXP, lenMAC_ADDRESS, pX.pc8);
 				break;
 			}
@@ -1379,9 +2931,18 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 				// retrieve implied/hidden size parameter if not specified...
 				X32.iX = sXP.flg.bPrecis ? sXP.flg.Precis : va_arg(sXP.vaList, int);
 				pX.pc8 = va_arg(sXP.vaList, char *);	// retrieve the pointer to data
-				IF_myASSERT(debugTRACK, halMemoryANY(pX.pc8));
+				IF_myASSERT(debugTRACK, xpfMEM_ANY(pX.pc8));
 				sXP.flg.uForm = form3X;
-				vPrintHexDump(&sXP, X32.iX, pX.pc8);
+				if (sXP.flg.bArray) {					// '&' 2nd pointer, diff old vs new
+					char * pNew = va_arg(sXP.vaList, char *);
+					IF_myASSERT(debugTRACK, xpfMEM_ANY(pNew));
+					vPrintHexDiff(&sXP, X32.iX, pX.pc8, pNew);
+					#if	(xpfSUPPORT_SGR == 1)
+					xpfSGR_FORGET(psSGR);				// diff colours sent, attributes unknown
+					#endif
+				} else {
+					vPrintHexDump(&sXP, X32.iX, pX.pc8);
+				}
 				break;
 			}
 			#endif
@@ -1397,19 +2958,22 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 				X32.iX = S_bytes[sXP.flg.uSize] * BITS_IN_BYTE;
 				if (sXP.flg.MinWid)
 					X32.iX = (sXP.flg.MinWid > X32.iX) ? X32.iX : sXP.flg.MinWid;
-				u64_t mask = 1ULL << (X32.iX - 1);
-				vPrintString(&sXP, sXP.flg.bCase ? "0B" : "0b");
-				
-				while (mask) {
-					xPrintChar(&sXP, (X64.u64 & mask) ? CHR_1 : CHR_0);
-					mask >>= 1;
-					// handle the complex grouping separator(s) boundary 8 use '|' or 4 use '-'
-					if (--X32.iX && sXP.flg.bGroup && (X32.iX % 4) == 0) {
-						xPrintChar(&sXP, X32.iX % 32 == 0 ? CHR_VERT_BAR :			// word
-										  X32.iX % 16 == 0 ? CHR_COLON :			// short
-									  	  X32.iX % 8 == 0 ? CHR_SPACE : CHR_MINUS);	// byte or nibble
-					}
+				if (X32.iX > 64)
+					X32.iX = 64;
+				char Buffer[2 + 64 + 15];				// prefix, bits, separators
+				Buffer[0] = CHR_0;
+				Buffer[1] = sXP.flg.bCase ? CHR_B : CHR_b;
+				int Len = X32.iX & 3 ? X32.iX & 3 : 4;	// leading, possibly partial, nibble
+				memcpy(&Buffer[2], &caNibble[((X64.u64 >> (X32.iX - Len)) & 0xF) * 4 + 4 - Len], Len);
+				Len += 2;
+				// remaining whole nibbles, separator selected by nibbles remaining, 8 use '|' ... 1 use '-'
+				for (int Rem = (X32.iX - 1) >> 2; Rem > 0; --Rem) {
+					if (sXP.flg.bGroup)
+						Buffer[Len++] = caBinSep[Rem & 7];
+					memcpy(&Buffer[Len], &caNibble[((X64.u64 >> ((Rem - 1) * 4)) & 0xF) * 4], 4);
+					Len += 4;
 				}
+				xPrintChars(&sXP, Buffer, Len);
 				break;
 			}
 
@@ -1459,6 +3023,23 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 				break;
 			#endif
 
+			#if	(xpfSUPPORT_FIXED == 1)
+			/* Fixed point, 2 parameters being SCALE and VALUE, no float math
+			 * 'q'	SCALE decimal digits, centi-degrees 2150 with 2 is "21.5"
+			 * 'Q'	SCALE fractional bits, Q16.16 0x00018000 with 16 is "1.5"
+			 * VALUE always signed, precision, width, sign & grouping as 'f' */
+			case CHR_q: {
+				X32.iX = va_arg(sXP.vaList, int);		// scale, digits or bits
+				sXP.flg.bSigned = 1;
+				sXP.flg.bAltF = 0;						// no SI scaling of the whole part
+				sXP.flg.uForm = form1F;
+				sXP.flg.Precis = sXP.flg.bPrecis ? (sXP.flg.Precis > xpfMAXIMUM_DECIMALS ? xpfMAXIMUM_DECIMALS : sXP.flg.Precis) : xpfDEFAULT_DECIMALS;
+				X64 = x64PrintGetValue(&sXP);
+				vPrintFixed(&sXP, X64, X32.iX);
+				break;
+			}
+			#endif
+
 			case CHR_m: {
 				pX.pc8 = strerror(errno);
 				goto commonM_S;
@@ -1500,7 +3081,7 @@ int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * p
 			commonM_S:
 				// Required to avoid crash when wifi message is intercepted and a string pointer parameter
 				// is evaluated as out of valid memory address (0xFFFFFFE6). Replace string with "pOOR"
-				pX.pc8 = halMemoryANY(pX.pc8) ? pX.pc8 : pX.pc8 ? strOOR : strNULL;
+				pX.pc8 = xpfMEM_ANY(pX.pc8) ? pX.pc8 : pX.pc8 ? strOOR : strNULL;
 				vPrintStringJustified(&sXP, pX.pc8);
 				break;
 			}
@@ -1521,6 +3102,10 @@ out_lbl:
 	return sXP.CurLen;
 }
 
+int	xPrintFX(int (Hdlr)(xp_t *, int), void * pvPara, size_t Size, const char * pcFmt, va_list vaList) {
+	return xPrintFXState(Hdlr, pvPara, Size, NULL, pcFmt, vaList);
+}
+
 // #################################### Destination handlers #######################################
 
 int xPrintToString(xp_t * psXP, int iChr) {
@@ -1618,35 +3203,242 @@ int fprintfx(FILE * stream, const char * pcFmt, ...) {
  * each other's output. Same mutex as xvReport(), so whole messages cannot interleave.
  *
  * STAGED (fast) path: render into this core's staging buffer under the STAGE lock, then emit the
- * finished block with a single xStdioWrite under the CONSOLE lock. Two benefits over rendering
- * straight to the handle: the console lock is held for one block copy instead of a whole format,
- * and the two cores format concurrently. Lock order is stage -> uart, never the reverse.
+ * finished block(s) with xStdioWrite under the CONSOLE lock. Two benefits over rendering straight to
+ * the handle: the console lock is held for block copies instead of a whole format, and the two cores
+ * format concurrently. Lock order is stage -> uart, never the reverse.
+ *
+ * A message larger than the stage block SPILLS into blocks claimed from a small pool shared by both
+ * cores, chained behind the stage block, so it is still formatted exactly once and emitted as a
+ * block list under one short lock hold. Only if the pool runs dry mid-render is the chain flushed
+ * early, and then the uart lock is kept from that flush to the end of the message so it cannot be
+ * interleaved. The character-at-a-time path remains only for a stage that cannot be taken at all:
+ * nested deeper than xpfNEST_DEPTH, or busy past the timeout. printfx therefore stays UNBOUNDED
+ * where syslog truncates.
  *
- * The staged render is a dry run - nothing has been emitted when it completes - so ANY reason it
- * cannot be used simply falls through to the original character-at-a-time path with the untouched
- * vaList: buffer nested, buffer busy past the timeout, or output larger than the buffer. That last
- * case is why the render uses a va_copy, and why printfx stays UNBOUNDED where syslog truncates. */
+ * NESTED calls (printfx from a handler, an assert, or anything else running while this task already
+ * owns a stage) never wait on the stage they hold themselves. The owner of each stage is recorded,
+ * and a nested call takes the next buffer from that stage's small depth stack instead. Inner
+ * messages complete, and are emitted, before the outer one. The uart lock is taken through
+ * xPrintfxUartLock(), which records the owner and does not wait when the caller already holds it,
+ * so the emit cannot self-deadlock either. */
+
+static TaskHandle_t UartOwner = NULL;					// task holding the uart lock through printfx
+
+int xPrintfxUartLock(unsigned int Ticks) {
+	TaskHandle_t Self = xTaskGetCurrentTaskHandle();
+	if (__atomic_load_n(&UartOwner, __ATOMIC_ACQUIRE) == Self)
+		return 0;										// already held, nothing taken
+	if (halUartLockOnce(Ticks) != pdTRUE)
+		return 0;
+	__atomic_store_n(&UartOwner, Self, __ATOMIC_RELEASE);
+	return 1;
+}
+
+void vPrintfxUartUnLock(int bTaken) {
+	if (bTaken == 0)
+		return;
+	__atomic_store_n(&UartOwner, NULL, __ATOMIC_RELEASE);
+	halUartUnLockOnce(pdTRUE);
+}
+
+int xPrintfxUartOwned(void) { return __atomic_load_n(&UartOwner, __ATOMIC_ACQUIRE) == xTaskGetCurrentTaskHandle(); }
+
+static char caSpill[xpfSPILL_BLOCKS][xpfSPILL_SIZE];
+static u32_t SpillMap = 0;								// claimed spill blocks, 1 bit per block
+
+typedef struct {
+	char * pcNow;										// next free position in the current block
+	char * pcEnd;										// end of the current block
+	u32_t Map;											// spill blocks claimed by this chain
+	int Idx;											// stage index, for vStdStageGive()
+	int bLock;											// early flush took the uart lock
+	u16_t Size;											// bytes in block [0], stage or nest buffer
+	u8_t Blocks;										// blocks in the chain, [0] is the stage block
+	u8_t Depth;											// 0 = stage block, else nest buffer [Depth-1]
+	u8_t bHeld : 1;										// early flush done, uart lock held to the end
+	u8_t bTrunc : 1;									// pool dry => drop characters, never flush
+	struct { char * pcBuf; u16_t Len; } sBlk[1 + xpfSPILL_BLOCKS];
+} xpstage_t;
+
+typedef struct {
+	TaskHandle_t Owner;									// task holding the stage, NULL if free
+	u8_t Depth;											// nest buffers in use
+	char caBuf[xpfNEST_DEPTH][xpfNEST_SIZE];
+} xpnest_t;
+
+static xpnest_t sNest[portNUM_PROCESSORS];				// indexed by stage
+
+/**
+ * @brief	claim a free block from the spill pool
+ * @return	index of the block claimed, erFAILURE if the pool is dry
+ */
+static int xPrintSpillTake(void) {
+	u32_t Map = __atomic_load_n(&SpillMap, __ATOMIC_RELAXED);
+	do {
+		u32_t Free = ~Map & ((1UL << xpfSPILL_BLOCKS) - 1);
+		if (Free == 0)
+			return erFAILURE;
+		Free &= -Free;									// lowest free block only
+		if (__atomic_compare_exchange_n(&SpillMap, &Map, Map | Free, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			return __builtin_ctz(Free);
+	} while (1);
+}
+
+/**
+ * @brief	take a head block for a new chain, this core's stage or, if nested, the next nest buffer
+ * @return	1 if taken, 0 if nested too deep or busy past the timeout
+ */
+static int xPrintStageTake(xpstage_t * psS, TickType_t tWait) {
+	char * pcBuf;
+	TaskHandle_t Self = xTaskGetCurrentTaskHandle();
+	for (int i = 0; i < portNUM_PROCESSORS; ++i) {
+		if (sNest[i].Owner != Self)
+			continue;
+		if (sNest[i].Depth == xpfNEST_DEPTH)			// too deep, slow path
+			return 0;
+		pcBuf = sNest[i].caBuf[sNest[i].Depth++];
+		psS->Idx = i;
+		psS->Depth = sNest[i].Depth;
+		psS->Size = xpfNEST_SIZE;
+		goto init;
+	}
+	pcBuf = pcStdStageTake(&psS->Idx, tWait);
+	if (pcBuf == NULL)
+		return 0;
+	IF_myASSERT(debugTRACK, psS->Idx < portNUM_PROCESSORS);
+	sNest[psS->Idx].Owner = Self;
+	psS->Depth = 0;
+	psS->Size = xStdStageSize();
+init:
+	psS->sBlk[0].pcBuf = psS->pcNow = pcBuf;
+	psS->pcEnd = pcBuf + psS->Size;
+	psS->Map = 0;
+	psS->Blocks = 1;
+	psS->bHeld = psS->bTrunc = 0;
+	return 1;
+}
+
+#if (printfxTESTS > 0)
+	void (* pfPrintfxNestHook)(int Depth) = NULL;
+	void (* pfPrintfxWriteHook)(const char * pcBuf, size_t Len) = NULL;	// collects blocks instead
+#endif
+
+/**
+ * @brief	emit every block in the chain, caller holds the uart lock
+ * @return	number of characters written
+ */
+static int xPrintStageWrite(xpstage_t * psS) {
+	int iRV = 0;
+	psS->sBlk[psS->Blocks - 1].Len = psS->pcNow - psS->sBlk[psS->Blocks - 1].pcBuf;
+	for (int i = 0; i < psS->Blocks; ++i) {
+		#if (printfxTESTS > 0)
+		if (pfPrintfxWriteHook)
+			pfPrintfxWriteHook(psS->sBlk[i].pcBuf, psS->sBlk[i].Len);
+		else
+		#endif
+		xStdioWrite(STDOUT_FILENO, psS->sBlk[i].pcBuf, psS->sBlk[i].Len);
+		iRV += psS->sBlk[i].Len;
+	}
+	return iRV;
+}
+
+/**
+ * @brief	release the spill blocks and restart the chain on the (now empty) stage block
+ */
+static void vPrintStageReset(xpstage_t * psS) {
+	__atomic_fetch_and(&SpillMap, ~psS->Map, __ATOMIC_RELEASE);
+	psS->Map = 0;
+	psS->Blocks = 1;
+	psS->pcNow = psS->sBlk[0].pcBuf;
+	psS->pcEnd = psS->pcNow + psS->Size;
+}
+
+/**
+ * @brief	release the whole chain, head block included
+ */
+static void vPrintStageGive(xpstage_t * psS) {
+	vPrintStageReset(psS);
+	if (psS->Depth) {
+		--sNest[psS->Idx].Depth;
+		return;
+	}
+	sNest[psS->Idx].Owner = NULL;
+	vStdStageGive(psS->Idx);
+}
+
+/**
+ * @brief	current block full, chain a spill block or, if the pool is dry, flush early
+ * @return	1 if space is available, 0 if the character must be dropped (bTrunc)
+ */
+static int xPrintStageNext(xpstage_t * psS) {
+	int Blk = (psS->Blocks <= xpfSPILL_BLOCKS) ? xPrintSpillTake() : erFAILURE;
+	if (Blk != erFAILURE) {
+		psS->sBlk[psS->Blocks - 1].Len = psS->pcNow - psS->sBlk[psS->Blocks - 1].pcBuf;
+		psS->sBlk[psS->Blocks++].pcBuf = psS->pcNow = caSpill[Blk];
+		psS->pcEnd = psS->pcNow + xpfSPILL_SIZE;
+		psS->Map |= 1UL << Blk;
+		return 1;
+	}
+	if (psS->bTrunc)
+		return 0;
+	if (psS->bHeld == 0) {								// first early flush, keep the lock to the end
+		psS->bLock = xPrintfxUartLock(WPFX_TIMEOUT);
+		psS->bHeld = 1;
+	}
+	xPrintStageWrite(psS);
+	vPrintStageReset(psS);
+	return 1;
+}
+
+/**
+ * @brief	stage chain handler, VER0 single character interface
+ */
+static int xPrintToStage(xp_t * psXP, int iChr) {
+	xpstage_t * psS = psXP->pvPara;
+	if (psS->pcNow == psS->pcEnd && xPrintStageNext(psS) == 0)
+		return erFAILURE;
+	*psS->pcNow++ = iChr;
+	return iChr;
+}
+
+/**
+ * @brief	stage chain handler, block interface for xPrintChars()
+ * @return	number of characters stored, short only if truncating (bTrunc)
+ */
+static size_t xPrintStageChars(xp_t * psXP, const char * pcSrc, size_t Len) {
+	xpstage_t * psS = psXP->pvPara;
+	size_t Done = 0;
+	while (Done < Len) {
+		if (psS->pcNow == psS->pcEnd && xPrintStageNext(psS) == 0)
+			break;
+		size_t Now = psS->pcEnd - psS->pcNow;
+		if (Now > Len - Done)
+			Now = Len - Done;
+		memcpy(psS->pcNow, pcSrc + Done, Now);
+		psS->pcNow += Now;
+		Done += Now;
+	}
+	#if (printfxTESTS > 0)
+	if (pfPrintfxNestHook && Done)
+		pfPrintfxNestHook(psS->Depth);					// nest mid-render, chain partly filled
+	#endif
+	return Done;
+}
+
 int vprintfx(const char * pcFmt, va_list vaList) {
-	int Idx, iRV;
-	char * pcBuf = pcStdStageTake(&Idx, WPFX_TIMEOUT);
-	if (pcBuf) {
-		int Size = (int) xStdStageSize();
-		va_list vaCopy;
-		va_copy(vaCopy, vaList);
-		iRV = xPrintFX(xPrintToString, pcBuf, Size, pcFmt, vaCopy);
-		va_end(vaCopy);
-		if (iRV < Size) {								// fitted (CurLen caps AT MaxLen, so == is overflow)
-			BaseType_t btRV = halUartLockOnce(WPFX_TIMEOUT);
-			xStdioWrite(STDOUT_FILENO, pcBuf, iRV);
-			halUartUnLockOnce(btRV);
-			vStdStageGive(Idx);
-			return iRV;
-		}
-		vStdStageGive(Idx);								// too big, discard and render it properly below
-	}
-	BaseType_t btRV = halUartLockOnce(WPFX_TIMEOUT);
+	int iRV;
+	xpstage_t sStage;
+	if (xPrintStageTake(&sStage, WPFX_TIMEOUT)) {
+		iRV = xPrintFX(xPrintToStage, &sStage, 0, pcFmt, vaList);
+		int bLock = sStage.bHeld ? sStage.bLock : xPrintfxUartLock(WPFX_TIMEOUT);
+		xPrintStageWrite(&sStage);
+		vPrintfxUartUnLock(bLock);
+		vPrintStageGive(&sStage);
+		return iRV;
+	}
+	int bLock = xPrintfxUartLock(WPFX_TIMEOUT);
 	iRV = xPrintFX(xPrintToHandle, (void *) STDOUT_FILENO, 0, pcFmt, vaList);
-	halUartUnLockOnce(btRV);
+	vPrintfxUartUnLock(bLock);
 	return iRV;
 }
 
@@ -1658,6 +3450,175 @@ int printfx(const char * pcFmt, ...) {
 	return iRV;
 }
 
+// ############################ Destination = STDOUT, deadline bounded #############################
+
+static pxd_site_t * psPXDlist = NULL;					// sites with 1+ drops, newest first
+
+/**
+ * @brief	convert an absolute deadline into the lock wait, in ticks, still available
+ * @return	ticks remaining, 0 if less than a tick (ie try once) or already expired
+ */
+static TickType_t xPrintDeadlineTicks(u64_t Deadline) {
+	u64_t Now = halTIMER_ReadRunTime();
+	if (Now >= Deadline)
+		return 0;
+	u64_t uSecs = Deadline - Now;						// whole seconds first, cannot overflow
+	u64_t Ticks = (uSecs / MICROS_IN_SECOND) * configTICK_RATE_HZ + (uSecs % MICROS_IN_SECOND) * configTICK_RATE_HZ / MICROS_IN_SECOND;
+	return (Ticks < portMAX_DELAY) ? (TickType_t) Ticks : portMAX_DELAY - 1;	// bounded, never forever
+}
+
+/**
+ * @brief	account for a dropped message, link the site into the drop list on its first drop
+ * @note	both cores can drop concurrently, hence the atomics. A site is never unlinked.
+ */
+static void vPrintDeadlineDrop(pxd_site_t * psSite) {
+	if (psSite == NULL)
+		return;
+	__atomic_fetch_add(&psSite->Drops, 1, __ATOMIC_RELAXED);
+	if (__atomic_exchange_n(&psSite->bListed, 1, __ATOMIC_ACQ_REL) == 0) {
+		psSite->psNext = __atomic_load_n(&psPXDlist, __ATOMIC_ACQUIRE);
+		while (!__atomic_compare_exchange_n(&psPXDlist, &psSite->psNext, psSite, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+	}
+}
+
+/* Same staged path as vprintfx() with every wait bounded by the caller's deadline, and without the
+ * slow fallback: that renders to the handle character-at-a-time with the uart lock held, which is
+ * exactly the unbounded stall a deadline caller cannot afford. So:
+ *	deadline passed on entry		-> dropped, nothing rendered
+ *	stage not available in time		-> dropped
+ *	larger than stage + spill pool	-> TRUNCATED, the chain is never flushed early, emitted
+ *	uart lock not available in time	-> dropped, the render is discarded
+ * The render itself goes to RAM and cannot block, so the lock wait is the only one that remains.
+ * Deadlines closer than a tick become a single try (0 ticks) on both waits. */
+int vtprintfx(pxd_site_t * psSite, u64_t Deadline, const char * pcFmt, va_list vaList) {
+	int iRV = xpfDROPPED;
+	xpstage_t sStage;
+	if (halTIMER_ReadRunTime() < Deadline && xPrintStageTake(&sStage, xPrintDeadlineTicks(Deadline))) {
+		sStage.bTrunc = 1;
+		xPrintFX(xPrintToStage, &sStage, 0, pcFmt, vaList);
+		int bOwned = xPrintfxUartOwned();				// sLO..sUL sequence or outer early flush
+		int bLock = xPrintfxUartLock(xPrintDeadlineTicks(Deadline));
+		if (bLock || bOwned)							// neither => timed out, dropped
+			iRV = xPrintStageWrite(&sStage);
+		vPrintfxUartUnLock(bLock);
+		vPrintStageGive(&sStage);
+	}
+	if (iRV == xpfDROPPED)
+		vPrintDeadlineDrop(psSite);
+	return iRV;
+}
+
+int tprintfx(pxd_site_t * psSite, u64_t Deadline, const char * pcFmt, ...) {
+	va_list vaList;
+	va_start(vaList, pcFmt);
+	int iRV = vtprintfx(psSite, Deadline, pcFmt, vaList);
+	va_end(vaList);
+	return iRV;
+}
+
+void vPrintfxDropReport(int bReset) {
+	u32_t Sites = 0, Total = 0;
+	for (pxd_site_t * psSite = __atomic_load_n(&psPXDlist, __ATOMIC_ACQUIRE); psSite; psSite = psSite->psNext) {
+		u32_t Drops = bReset ? __atomic_exchange_n(&psSite->Drops, 0, __ATOMIC_RELAXED) : psSite->Drops;
+		PX("[PXD] %s:%d dropped %lu" strNL, psSite->pcFunc, psSite->Line, Drops);
+		Total += Drops;
+		++Sites;
+	}
+	PX("[PXD] %lu drops from %lu sites" strNL, Total, Sites);
+}
+
+// ########################### Destination = STDOUT, streaming hexdump ############################
+
+/* %Y holds the console for the whole dump and needs addressable memory. The cursor form renders the
+ * same lines with the same line kernel, but a step at a time with the console locked per line, so
+ * other output interleaves between lines and steps. Data comes through a Read() callback, prefetched
+ * in blocks of whole lines, so flash, EEPROM or anything else behind a driver can be dumped. */
+
+#if	(xpfSUPPORT_HEXDUMP == 1)
+int xPrintfxDumpBegin(xpdump_t * psD, int Options, int Width, unsigned long Len, uintptr_t Addr,
+					int (* Read)(void *, unsigned long, void *, int), void * pvPara) {
+	if ((Read == NULL && xpfMEM_ANY(pvPara) == 0) || (Width && INRANGE(8, Width, xpfMAXWIDTH_HEXDUMP) == 0))
+		return erFAILURE;
+	memset(psD, 0, sizeof(xpdump_t));
+	psD->Read = Read;
+	psD->pvPara = pvPara;
+	psD->Addr = Addr;
+	psD->Len = Len;
+	xp_t sXP = { 0 };
+	sXP.flg.bRelVal = (Options & xpdREL) ? 1 : 0;
+	sXP.flg.bLeft = (Options & xpdNOADDR) ? 1 : 0;
+	sXP.flg.bPlus = (Options & xpdASCII) ? 1 : 0;
+	sXP.flg.bGroup = (Options & xpdGROUP) ? 1 : 0;
+	sXP.flg.bAltF = (Options & xpdREVERSE) ? 1 : 0;
+	sXP.flg.bPad0 = (Options & xpdSQUEEZE) ? 1 : 0;
+	sXP.flg.uForm = form3X;
+	int Bytes = 1 << ((Options & xpdSIZE) >> 5);
+	for (sXP.flg.uSize = S_none; S_bytes[sXP.flg.uSize] != Bytes; ++sXP.flg.uSize)
+		if (sXP.flg.uSize == S_XXX - 1)
+			return erFAILURE;							// no C type of that size
+	if (Width) {
+		sXP.flg.bMinWid = 1;
+		sXP.flg.MinWid = Width;
+	}
+	psD->Width = xPrintHexDumpWidth(&sXP);
+	psD->sXPC.u64XPC = sXP.u64XPC;
+	return (Len + psD->Width - 1) / psD->Width;
+}
+
+int xPrintfxDumpStep(xpdump_t * psD, int Lines) {
+	char caLine[2 * xpfLEN_HEXLINE];					// room for a "*" line and the line after
+	xp_t sXP = { 0 };
+	while (Lines-- && psD->Offset < psD->Len) {
+		int Width = (psD->Len - psD->Offset) > psD->Width ? psD->Width : psD->Len - psD->Offset;
+		const char * pData;
+		if (psD->Read == NULL) {
+			pData = (const char *) psD->pvPara + psD->Offset;
+		} else {
+			if ((psD->BufLen - psD->BufOfs) < Width) {	// prefetch the next block of whole lines
+				int Size = (xpfDUMP_BLOCK / psD->Width) * psD->Width;
+				if (Size > (psD->Len - psD->Offset))
+					Size = psD->Len - psD->Offset;
+				int iRV = psD->Read(psD->pvPara, psD->Offset, psD->caBuf, Size);
+				if (iRV < Width)
+					return erFAILURE;
+				psD->BufLen = iRV;
+				psD->BufOfs = 0;
+			}
+			pData = (const char *) psD->caBuf + psD->BufOfs;
+			psD->BufOfs += Width;
+		}
+		sXP.u64XPC = psD->sXPC.u64XPC;
+		if (sXP.flg.bPad0) {							// suppress duplicates, see vPrintHexDump()
+			if (psD->Offset && (psD->Offset + psD->Width) < psD->Len && memcmp(pData, psD->caPrev, Width) == 0) {
+				++psD->Dups;
+				psD->Offset += Width;
+				continue;
+			}
+			memcpy(psD->caPrev, pData, Width);
+		}
+		int Len = 0;
+		if (psD->Dups) {
+			Len = xPrintHexDumpSkip(caLine, psD->Dups);
+			psD->Dups = 0;
+		}
+		uintptr_t Addr = sXP.flg.bRelVal ? psD->Offset : psD->Addr + psD->Offset;
+		Len += xPrintHexDumpLine(&sXP, psD->sXPC.u64XPC, caLine + Len, pData, Addr, Width, psD->Width, psD->Len);
+		int bLock = xPrintfxUartLock(WPFX_TIMEOUT);
+		#if (printfxTESTS > 0)
+		if (pfPrintfxWriteHook)
+			pfPrintfxWriteHook(caLine, Len);
+		else
+		#endif
+		xStdioWrite(STDOUT_FILENO, caLine, Len);
+		vPrintfxUartUnLock(bLock);
+		psD->Offset += Width;
+	}
+	return (psD->Len - psD->Offset + psD->Width - 1) / psD->Width;
+}
+
+void vPrintfxDumpEnd(xpdump_t * psD) { psD->Offset = psD->Len; }
+#endif
+
 // ################################### Destination = CONSOLE #######################################
 
 #if defined(ESP_PLATFORM)								// only available on ESP32
@@ -74,7 +74,7 @@ int	xvReport(report_t * psR, const char * pcFmt, va_list vaList) {
 		/* The held/not-held state MUST live in the report_t, NOT on the stack: an sLO..sUL sequence
 		 * spans several calls, so a local is destroyed long before the matching sUL arrives and the
 		 * mutex would never be released. */
-		psR->bLocked = (halUartLockOnce(WPFX_TIMEOUT) == pdTRUE);
+		psR->bLocked = xPrintfxUartLock(WPFX_TIMEOUT);
 	} else if (psR->XLock == sINV5 || psR->XLock == sINV6) {
 		RP("Xlock=%d" strNL, psR->XLock);
 		esp_backtrace_print(6);
@@ -83,10 +83,14 @@ int	xvReport(report_t * psR, const char * pcFmt, va_list vaList) {
 		// sNONE, sUL, sNL, sBUFFER are OK
 	}
 	// generate formatted output to specified channel
+	#if defined(printfxVER0)
+	iRV = xPrintFXState(psR->hdlr, psR->pcBuf, psR->Size, psR->psSGR, pcFmt, vaList);
+	#else
 	iRV = xPrintFX(psR->hdlr, psR->pcBuf, psR->Size, pcFmt, vaList);
+	#endif
 	// act on Xlock value, unlock semaphore if required, update pointers if output to buffer
 	if (psR->XLock == sUL || psR->XLock == sLO_UL) {
-		halUartUnLockOnce(psR->bLocked ? pdTRUE : pdFALSE);	// unlock only if THIS report_t took it
+		vPrintfxUartUnLock(psR->bLocked);				// unlock only if THIS report_t took it
 		psR->bLocked = 0;
 		if (psR->XLock == sUL)							// sUL is transient
 			psR->XLock = sNONE;							// clear
@@ -119,10 +123,16 @@ int	xReportBitMap(report_t * psR, u32_t V1, u32_t V2, u32_t Mask, const char * c
 
 	int	pos, idx, iFS = 31 - __builtin_clzl(Mask);		// determine index of first bit set
 	bool B1, B2, aColor = (psR && psR->uSGR) ? 1 : 0;
-	const char * pccTmp, * pFormat = aColor ? "%C%s%C " : "%c%s%c ";
+	const char * pccTmp, * pFormat = aColor ? "%C%s " : "%c%s%c ";
 	char caTmp[16];
 	int iRV = 0;
 	u32_t Col, CurMask;
+	/* Colour labels leave their colour set, the next label only changes it if different and one reset
+	 * follows the last. Without stream state from the caller, one is kept for this sequence, the
+	 * console is locked throughout so nothing else can change the attributes in between. */
+	xpsgr_t sSGR = { 0 }, * psSaved = psR ? psR->psSGR : NULL;
+	if (aColor && psSaved == NULL)
+		psR->psSGR = &sSGR;
 	repSET(XLock, sLO);									// will be changed to sNL automatically
 	for (pos = iFS, idx = iFS, CurMask = (1<<iFS); pos >= 0; CurMask >>= 1, --pos, --idx) {
 		if (Mask & CurMask) {
@@ -144,15 +154,19 @@ int	xReportBitMap(report_t * psR, u32_t V1, u32_t V2, u32_t Mask, const char * c
 					snprintfx(caTmp, sizeof(caTmp), "%d/x%X", idx, 1 << idx);
 					pccTmp = caTmp;
 				}
-				iRV += xReport(psR, pFormat, Col, pccTmp, 0);	// print "label"" with colour/char then reset color
+				iRV += xReport(psR, pFormat, Col, pccTmp, 0);	// print "label" with colour, or between chars
 			}
 		}
 	}
 	repSET(XLock, sUL);									// ensure flag is set to UNLOCK
-	if (iRV) {											// if any output generated append hex value
+	if (iRV && aColor) {								// reset colour, append hex value
+		iRV += xReport(psR, "%C(x%0.*X)%s", xpfCOL(attrRESET, 0), iFS+2, V2, fmTST(aNL) ? strNL : strNUL);
+	} else if (iRV) {									// if any output generated append hex value
 		iRV += xReport(psR, "(x%0.*X)%s", iFS+2, V2, fmTST(aNL) ? strNL : strNUL);
 	} else {
 		iRV += xReport(psR, strNUL);					// no output, just unlock
 	}
+	if (aColor)
+		psR->psSGR = psSaved;
 	return iRV;
 }